@@ -1,5 +1,5 @@
 // F1 TERMINAL RACER 2025 - ENHANCED EDITION
-// Compile with: g++ -std=c++17 f1_enhanced.cpp -o f1
+// Compile with: g++ -std=c++17 F1game.cpp f1sim.cpp -o f1   (or build with CMake)
 
 #include <iostream>
 #include <vector>
@@ -10,9 +10,24 @@
 #include <numeric>
 #include <limits>
 #include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <thread>
+#ifdef _WIN32
 #include <windows.h>
+#endif
 #include <map>
 
+#include "f1sim.h"
+#include "f1flow.h"
+#include "f1lookahead.h"
+#include "f1perf.h"
+#include "f1policy.h"
+#include "f1report.h"
+#include "f1store.h"
+#include "f1trackmap.h"
+
 using namespace std;
 
 // ---------- Utility & Globals ----------
@@ -23,7 +38,17 @@ const char *CLEAR_CMD = "clear";
 
 #endif
 
-std::mt19937 rng((unsigned)chrono::high_resolution_clock::now().time_since_epoch().count());
+// Built offline with `f1batch policy-build f1policy.bin`; AI falls back to
+// aiChooseStrategy when the file is missing.
+const char *POLICY_FILE = "f1policy.bin";
+PolicyTable aiPolicy;
+
+// Finished races are appended here; query with `f1batch store-query f1results`.
+const char *RESULTS_DIR = "f1results";
+
+// Endurance races show the race screen and take a strategy call every few laps
+const int ENDURANCE_MAX_LAPS = 5000;
+const int ENDURANCE_SHOW_EVERY = 10;
 
 void pressAnyKey()
 {
@@ -32,266 +57,7 @@ void pressAnyKey()
     cin.get();
 }
 
-string formatTime(double seconds)
-{
-    if (seconds < 0.0)
-        seconds = 0.0;
-    int total_ms = (int)round(seconds * 1000.0);
-    int ms = total_ms % 1000;
-    int total_s = total_ms / 1000;
-    int s = total_s % 60;
-    int m = total_s / 60;
-    char buf[64];
-    sprintf(buf, "%d:%02d.%03d", m, s, ms);
-    return string(buf);
-}
-
-template <typename T>
-T clampVal(T v, T lo, T hi) { return v < lo ? lo : (v > hi ? hi : v); }
-
-// ---------- Data Structures ----------
-
-struct Driver
-{
-    string name;
-    int speed, cornering, overtaking, consistency, aggression, strategy;
-    string team;
-};
-
-struct Track
-{
-    string name, country, asciiMap;
-    double baseLapSec;
-    int difficulty, corners;
-    double pitStopTime;
-};
-
-struct Racer
-{
-    string displayName;
-    Driver driver;
-    double cumulativeTime = 0.0, lastLapTime = 0.0, fastestLap = 1e9;
-    double tyre = 100.0, vehicle = 100.0;
-    int startingPos = 0, currentPos = 0, pitStops = 0;
-    bool inPitThisLap = false;
-};
-
-struct Team
-{
-    string name;
-    double performance;
-    string carModel;
-    int budget;
-};
-
-// ---------- Game Content ----------
-
-map<string, Team> teams = {
-    {"Red Bull", {"Red Bull Racing", 9.8, "RB21", 185000000}},
-    {"Ferrari", {"Scuderia Ferrari", 9.2, "SF-25", 145000000}},
-    {"Mercedes", {"Mercedes-AMG", 9.0, "W16", 155000000}},
-    {"McLaren", {"McLaren", 8.7, "MCL38", 135000000}},
-    {"Aston Martin", {"Aston Martin", 8.5, "AMR24", 125000000}},
-    {"Alpine", {"Alpine", 7.8, "A524", 95000000}},
-    {"RB", {"RB", 7.5, "VCARB01", 85000000}},
-    {"Haas", {"Haas", 7.2, "VF-24", 80000000}},
-    {"Williams", {"Williams", 7.0, "FW46", 75000000}},
-    {"Sauber", {"Kick Sauber", 6.8, "C44", 70000000}}};
-
-map<string, vector<Driver>> teamDrivers = {
-    {"Red Bull", {{"Max Verstappen", 10, 10, 10, 10, 9, 9, "Red Bull"}, {"Sergio Perez", 8, 7, 8, 8, 7, 8, "Red Bull"}}},
-    {"Ferrari", {{"Charles Leclerc", 9, 9, 8, 8, 8, 8, "Ferrari"}, {"Carlos Sainz", 8, 8, 7, 9, 7, 8, "Ferrari"}}},
-    {"Mercedes", {{"Lewis Hamilton", 9, 8, 8, 9, 7, 9, "Mercedes"}, {"George Russell", 8, 8, 8, 8, 8, 8, "Mercedes"}}},
-    {"McLaren", {{"Lando Norris", 9, 9, 9, 9, 8, 8, "McLaren"}, {"Oscar Piastri", 8, 8, 8, 8, 7, 7, "McLaren"}}},
-    {"Aston Martin", {{"Fernando Alonso", 8, 8, 8, 9, 7, 9, "Aston Martin"}, {"Lance Stroll", 6, 7, 7, 6, 7, 6, "Aston Martin"}}},
-    {"Alpine", {{"Pierre Gasly", 7, 7, 7, 7, 8, 7, "Alpine"}, {"Esteban Ocon", 7, 7, 7, 8, 7, 7, "Alpine"}}},
-    {"RB", {{"Yuki Tsunoda", 8, 6, 7, 7, 8, 6, "RB"}, {"Daniel Ricciardo", 7, 7, 8, 7, 7, 7, "RB"}}},
-    {"Haas", {{"Nico Hulkenberg", 7, 8, 7, 8, 6, 8, "Haas"}, {"Kevin Magnussen", 7, 6, 7, 6, 8, 6, "Haas"}}},
-    {"Williams", {{"Alex Albon", 7, 7, 8, 7, 7, 7, "Williams"}, {"Logan Sargeant", 6, 6, 6, 6, 6, 6, "Williams"}}},
-    {"Sauber", {{"Valtteri Bottas", 7, 7, 6, 8, 6, 8, "Sauber"}, {"Zhou Guanyu", 6, 7, 6, 7, 6, 7, "Sauber"}}}};
-
-map<string, Track> tracks = {
-    {"Monaco", {
-        "Monaco Street Circuit", 
-        "Monaco", 
-        "│               _____                 │\n"
-        "│              /     \\                │\n"
-        "│   __________/       │               │\n"
-        "│  │                  │               │\n"
-        "│  │                  │               │\n" 
-        "│  │         ________/                │\n"
-        "│  │        │                         │\n"
-        "│  │         \\                        │\n"
-        "│   \\         \\                       │\n"
-        "│    \\_________│                      │",
-        78.5,  // lapDistance (km)
-        9,     // laps
-        11,    // corners
-        17.0   // pitstopTime
-    }},
-    
-    {"Spa", {
-        "Spa-Francorchamps", 
-        "Belgium", 
-        "│   _______                           │\n"
-        "│  /       \\_________                 │\n"
-        "│ /                   \\               │\n"
-        "│ |                    |              │\n"
-        "│ |                    |              │\n"
-        "│  \\                  /               │\n"
-        "│   \\________ _______/                │\n"
-        "│           \\_/                       │", 
-        99.0,  // lapDistance (km)
-        8,     // laps
-        14,    // corners
-        21.0   // pitstopTime
-    }},
-    
-    {"Silverstone", {
-        "Silverstone Circuit", 
-        "UK", 
-        "│    ____                             │\n"
-        "│   /    \\          ____              │\n"
-        "│  /      \\____    |    |             │\n"
-        "│ |      ______|   /    |             │\n"
-        "│ |     |_________|     |             │\n"
-        "│  \\                   /              │\n"
-        "│   \\_________________/               │", 
-        95.0,  // lapDistance (km)
-        6,     // laps
-        17,    // corners
-        20.0   // pitstopTime
-    }},
-    
-    {"Monza", {
-        "Autodromo Nazionale Monza", 
-        "Italy", 
-        "│   ____________________              │\n"
-        "│  |                    |             │\n"
-        "│  |                    |             │\n"
-        "│  |    __        __    |             │\n"
-        "│  |   |  |      |  |   |             │\n"
-        "│  |   |  |      |  |   |             │\n"
-        "│   \\__|  |______|  |__/              │", 
-        85.0,  // lapDistance (km)
-        5,     // laps
-        14,    // corners
-        24.0   // pitstopTime
-    }}
-};
-
-// ---------- Core Logic ----------
-
-double driverSkillIndex(const Driver &d)
-{
-    return (d.speed + d.cornering + d.overtaking + d.consistency + d.aggression + d.strategy) / 6.0;
-}
-
-double computeLapTimeSeconds(const Racer &racer, const Track &track, int mode, bool isPlayer)
-{
-    double base = track.baseLapSec;
-    double skill = driverSkillIndex(racer.driver);
-    double skillReduction = (skill - 7.0) * 0.6;
-
-    double tyreFactor = 1.0;
-    if (racer.tyre < 80.0)
-        tyreFactor += (80.0 - racer.tyre) * 0.0018;
-    if (racer.tyre < 60.0)
-        tyreFactor += 0.01;
-    if (racer.tyre < 40.0)
-        tyreFactor += 0.02;
-
-    double vehicleFactor = 1.0 + (100.0 - racer.vehicle) * 0.001;
-    double modeDelta = (mode == 1) ? -0.6 : ((mode == 0) ? 0.4 : 0.0);
-
-    uniform_real_distribution<double> jitterDist(-0.6, 0.6);
-    double jitter = jitterDist(rng);
-
-    double lap = base + skillReduction + modeDelta;
-    lap *= tyreFactor * vehicleFactor;
-    lap += jitter;
-
-    return max(lap, 30.0);
-}
-
-void applyWearAndDamage(Racer &racer, int mode, bool hadPitThisLap)
-{
-    if (hadPitThisLap)
-    {
-        racer.tyre = 100.0;
-        racer.vehicle = clampVal(racer.vehicle + 2.0, 0.0, 100.0);
-        return;
-    }
-
-    double tyreDrop = 2.5;
-    double vehicleDrop = 0.0;
-
-    if (mode == 1)
-    {
-        tyreDrop = 5.0 + uniform_real_distribution<double>(-0.5, 1.5)(rng);
-        vehicleDrop = 0.8;
-    }
-    else if (mode == 0)
-    {
-        tyreDrop = 1.8 + uniform_real_distribution<double>(-0.4, 0.6)(rng);
-        vehicleDrop = 0.2;
-    }
-
-    racer.tyre = clampVal(racer.tyre - tyreDrop, 0.0, 100.0);
-    racer.vehicle = clampVal(racer.vehicle - vehicleDrop, 0.0, 100.0);
-}
-
-vector<Racer> makeField(const Driver &playerDrv, const string &playerName)
-{
-    vector<Racer> field;
-
-    // Create player
-
-    Racer player;
-    player.displayName = playerName;
-    player.driver = playerDrv;
-    field.push_back(player);
-
-    // Create AI opponents from all teams
-
-    for (auto &team : teamDrivers)
-    {
-        for (auto &driver : team.second)
-        {
-            if (driver.name != playerName)
-            {
-                Racer ai;
-                ai.displayName = driver.name;
-                ai.driver = driver;
-                field.push_back(ai);
-            }
-        }
-    }
-
-    return field;
-}
-
-void recomputePositions(vector<Racer> &field)
-{
-    vector<int> idx(field.size());
-    iota(idx.begin(), idx.end(), 0);
-    sort(idx.begin(), idx.end(), [&](int a, int b)
-         { return field[a].cumulativeTime < field[b].cumulativeTime; });
-
-    for (int i = 0; i < (int)idx.size(); ++i)
-    {
-        field[idx[i]].currentPos = i + 1;
-    }
-}
-
-int aiChooseStrategy(const Racer &r)
-{
-    if (r.tyre < 35.0)
-        return 2;
-    double skill = driverSkillIndex(r.driver);
-    double pushChance = 0.25 + (skill - 7.0) * 0.08;
-    return (uniform_real_distribution<double>(0.0, 1.0)(rng) < pushChance) ? 1 : 0;
-}
+// ---------- Commentary ----------
 
 string generateCommentary(const Racer &player, int oldPos, int newPos, double tyre, bool pitThisLap, int lap, int totalLaps, double lastLapTime)
 {
@@ -593,7 +359,7 @@ Driver getDriverSelection(const string &team)
     return drivers[choice - 1];
 }
 
-string getTrackSelection()
+string getTrackSelection(int totalLaps = kDefaultRaceLaps)
 {
     clearScreen();
     cout << "┌──────────────────────────────────────┐\n";
@@ -616,7 +382,7 @@ string getTrackSelection()
             difficulty = "EASY 🌟";
 
         printf("│   %d. %-16s                │\n", i + 1, trackNames[i].c_str());
-        printf("│      Length: %.2fkm | Laps: 25       │\n", tracks[trackNames[i]].baseLapSec / 10.0);
+        printf("│      Length: %.2fkm | Laps: %-9d│\n", tracks[trackNames[i]].baseLapSec / 10.0, totalLaps);
         printf("│      Pit Stop: %.1fs                 │\n", tracks[trackNames[i]].pitStopTime);
         printf("│      Difficulty:%-14s         │\n", difficulty.c_str());
         if (i < (int)trackNames.size() - 1)
@@ -658,7 +424,7 @@ string getTrackSelection()
     
     cout << "│                                     │\n";
     cout << "│ Track Length: " << tracks[selectedTrack].baseLapSec / 10.0 << "km" <<"                │"<< endl;
-    cout << "│ Laps: 25 | Corners: " << tracks[selectedTrack].corners <<"              │" << endl;
+    cout << "│ Laps: " << totalLaps << " | Corners: " << tracks[selectedTrack].corners <<"              │" << endl;
     cout << "│ Difficulty: " << tracks[selectedTrack].difficulty << "/10" "                    │" << endl;
     cout << "│ Pit Stop Time: " << tracks[selectedTrack].pitStopTime << "s" "                  │"<< endl;
     cout << "│                                     │\n";
@@ -671,7 +437,7 @@ string getTrackSelection()
 
 // Engineer advice
 
-string getEngineerAdvice(const Racer &player, int lap, int totalLaps, int playerPos, const vector<Racer> &field)
+string getEngineerAdvice(const Racer &player, int lap, int totalLaps, int playerPos, const pmr::vector<Racer> &field)
 {
     vector<string> advice;
 
@@ -694,11 +460,15 @@ string getEngineerAdvice(const Racer &player, int lap, int totalLaps, int player
         {
             if (field[i].currentPos == playerPos - 1)
             {
-                double gap = field[i].cumulativeTime - player.cumulativeTime;
-                if (gap < 3.0)
+                double gap = player.gapAhead;
+                if (gap < kDrsWindow)
                 {
                     advice.push_back("Gap to P" + to_string(playerPos - 1) + ": " + to_string(gap).substr(0, 3) + "s - within DRS!");
                 }
+                else if (gap < 3.0)
+                {
+                    advice.push_back("Gap to P" + to_string(playerPos - 1) + ": " + to_string(gap).substr(0, 3) + "s - get into DRS range!");
+                }
                 break;
             }
         }
@@ -711,7 +481,7 @@ string getEngineerAdvice(const Racer &player, int lap, int totalLaps, int player
         {
             if (field[i].currentPos == playerPos + 1)
             {
-                double gap = player.cumulativeTime - field[i].cumulativeTime;
+                double gap = field[i].gapAhead;
                 if (gap < 2.0)
                 {
                     advice.push_back("Car behind closing - " + to_string(gap).substr(0, 3) + "s gap!");
@@ -742,9 +512,123 @@ string getEngineerAdvice(const Racer &player, int lap, int totalLaps, int player
     return advice[uniform_int_distribution<int>(0, advice.size() - 1)(rng)];
 }
 
+// ---------- Live Track Map ----------
+
+const int MAP_FPS = 30;
+const double MAP_ANIMATION_SECONDS = 1.5;
+
+// Where every car is at race time t: share of its current lap, measured from
+// when it last crossed the line over that lap's length
+void plotField(TrackMap &map, const RaceFlow &flow, double t)
+{
+    const pmr::vector<Racer> &field = flow.state().field;
+    static vector<MapMarker> markers;
+    markers.resize(field.size());
+    for (size_t i = 0; i < field.size(); ++i)
+    {
+        MapMarker &m = markers[i];
+        m.lapFraction = (t - flow.lapStart((int)i)) / flow.lapLength((int)i);
+        if ((int)i == flow.state().playerIndex)
+        {
+            m.glyph = "\033[1;33m@\033[0m";
+            m.priority = 3;
+        }
+        else if (field[i].currentPos == 1)
+        {
+            m.glyph = "\033[1;35m1\033[0m";
+            m.priority = 2;
+        }
+        else
+        {
+            m.glyph = "o";
+            m.priority = 1;
+        }
+    }
+    map.plot(markers.data(), markers.size());
+}
+
+// Draws the map inside the race box; the cursor ends on the line below it
+void drawTrackMap(TrackMap &map)
+{
+    string out;
+    for (int r = 0; r < map.rows(); ++r)
+    {
+        out += "│  ";
+        map.renderRow(out, r);
+        out += "   │\n";
+    }
+    fputs(out.c_str(), stdout);
+    fflush(stdout);
+}
+
+// Replays the lap just run: race time sweeps from the leader's start of lap
+// to its end, and only cells whose car changed are redrawn each frame
+void animateLap(TrackMap &map, const RaceFlow &flow)
+{
+    double t0 = 1e18, t1 = 1e18;
+    for (int i = 0; i < (int)flow.state().field.size(); ++i)
+    {
+        t0 = min(t0, flow.lapStart(i));
+        t1 = min(t1, flow.lapStart(i) + flow.lapLength(i));
+    }
+
+    int frames = (int)(MAP_ANIMATION_SECONDS * MAP_FPS);
+    string out;
+    for (int f = 1; f <= frames; ++f)
+    {
+        auto frameStart = chrono::steady_clock::now();
+        plotField(map, flow, t0 + (t1 - t0) * f / frames);
+        out.clear();
+        map.renderChanges(out, 3);
+        fputs(out.c_str(), stdout);
+        fflush(stdout);
+        this_thread::sleep_until(frameStart + chrono::microseconds(1000000 / MAP_FPS));
+    }
+}
+
+// ---------- Look-Ahead Panel ----------
+
+const int LOOKAHEAD_ROWS = 4;
+const int LOOKAHEAD_REFRESH_MS = 200;
+
+// Row 0 is the title, rows 1-3 PUSH, SAVE and PIT; 42 columns inside the box
+string lookAheadLine(const LookAhead &lookAhead, int row)
+{
+    static const char *const names[] = {"PUSH", "SAVE", "PIT"};
+    char line[160];
+    if (row == 0)
+    {
+        snprintf(line, sizeof(line), "│    LOOK-AHEAD  %7lld races per option  │",
+                 lookAhead.estimate(1).rollouts);
+        return line;
+    }
+
+    LookAheadEstimate e = lookAhead.estimate(row);
+    const char *marker = (lookAhead.best() == row) ? "◀ BEST" : "      ";
+    if (e.rollouts == 0)
+        snprintf(line, sizeof(line), "│    %-5s expected P  ...          %s │", names[row - 1], marker);
+    else
+        snprintf(line, sizeof(line), "│    %-5s expected P%5.2f +/-%4.2f  %s │", names[row - 1], e.meanPosition,
+                 min(e.halfWidth, 9.99), marker);
+    return line;
+}
+
+// The panel sits rows lines above the prompt. Save the cursor, go up,
+// rewrite, restore: whatever the player is typing stays where it is.
+void redrawLookAhead(const LookAhead &lookAhead, int linesAbove)
+{
+    string out = "\0337\033[" + to_string(linesAbove) + "A\r";
+    for (int row = 0; row < LOOKAHEAD_ROWS; ++row)
+        out += lookAheadLine(lookAhead, row) + "\n";
+    out += "\0338";
+    fputs(out.c_str(), stdout);
+    fflush(stdout);
+}
+
 // run race funtion
 
-void runRace(const Driver &playerDriver, const string &playerName, const Track &track)
+void runRace(const Driver &playerDriver, const string &playerName, const Track &track, int totalLaps = kDefaultRaceLaps,
+             bool endurance = false)
 {
     clearScreen();
     cout << "┌─────────────────────────────────────┐\n";
@@ -761,32 +645,58 @@ void runRace(const Driver &playerDriver, const string &playerName, const Track &
     cout << "Grid is forming...\n";
     pressAnyKey();
 
-    auto field = makeField(playerDriver, playerName);
+    RaceState race;
+    race.keepHistory = endurance;
+    startRace(race, playerDriver, playerName, track, totalLaps);
+    if (!aiPolicy.empty())
+        race.policy = &aiPolicy;
+
+    // F1_PERF=1 in the environment prints per-phase counters after the race
+    PerfCounters perfCounters;
+    PerfCounters *perf = getenv("F1_PERF") ? &perfCounters : nullptr;
+    if (perf)
+        perf->open();
+    race.perf = perf;
+
+    pmr::vector<Racer> &field = race.field;
     int fieldSize = (int)field.size();
-    int playerIndex = 0;
-    int totalLaps = 25;
+    int playerIndex = race.playerIndex;
 
-    // Starting positions
+    double &fastestLapTime = race.fastestLapTime;
 
-    for (int i = 0; i < fieldSize; ++i)
-    {
-        field[i].cumulativeTime = i * 3.0;
-        field[i].startingPos = i + 1;
-    }
-    recomputePositions(field);
+    // Suspends before every lap on screen; endurance crews drive the rest
+    RaceFlow flow(race, endurance, ENDURANCE_SHOW_EVERY);
+    TrackMap map(track.asciiMap);
 
-    int playerMode = -1;
-    double fastestLapTime = 1e9;
-    string fastestLapHolder = "";
-    int lastPlayerPos = field[playerIndex].currentPos;
+    // Rolls PUSH, SAVE and PIT out to the flag while the player decides
+    LookAhead lookAhead;
 
-    for (int lap = 1; lap <= totalLaps; ++lap)
+    for (FlowWait wait = flow.resume(); wait != FlowWait::Finished;)
     {
+        int lap = flow.lap();
+        perfBegin(perf, kPhaseRender);
         clearScreen();
+        char lapText[24];
+        snprintf(lapText, sizeof(lapText), "LAP %2d/%d", lap, totalLaps);
         cout << "┌──────────────────────────────────────────┐\n";
-        printf("│    %-8s | LAP %2d/25 | POS: P%-2d       │\n",
-               track.name.substr(0, 8).c_str(), lap, field[playerIndex].currentPos);
+        printf("│    %-8s | %-9s | POS: P%-2d", track.name.substr(0, 8).c_str(), lapText, field[playerIndex].currentPos);
+        for (int i = 0; i < 7 - max(0, (int)strlen(lapText) - 9); ++i)
+            cout << " ";
+        cout << "│\n";
         cout << "├──────────────────────────────────────────┤\n";
+
+        // Track map, replaying the last lap
+
+        if (lap == 1)
+            plotField(map, flow, 0.0);
+        drawTrackMap(map);
+        if (lap > 1)
+        {
+            // The replay mostly sleeps, so it is left out of the render phase
+            perfEnd(perf, kPhaseRender);
+            animateLap(map, flow);
+            perfBegin(perf, kPhaseRender);
+        }
         cout << "│                                          │\n";
 
         // Car Status
@@ -797,12 +707,16 @@ void runRace(const Driver &playerDriver, const string &playerName, const Track &
         printf("│    ⏱️ Last Lap: %-12s              │\n", formatTime(p.lastLapTime).c_str());
         if (fastestLapTime < 1e9)
         {
-            printf("│    🏆 Fastest: %-12s (%-.3s)        │\n", formatTime(fastestLapTime).c_str(), fastestLapHolder.c_str());
+            printf("│    🏆 Fastest: %-12s (%-.3s)        │\n", formatTime(fastestLapTime).c_str(),
+                   field[race.fastestLapIndex].displayName);
         }
         else
         {
             cout << "│    🏆 Fastest: --:--.---                 │\n";
         }
+        const LapConditions &weather = race.conditions[lap];
+        printf("│    🌡️ Track: %2d°C   %s: %3d%%          │\n", weather.trackTempC,
+               weather.rain > 0 ? "🌧️ Rain" : "☀️ Rain", weather.rain);
         cout << "│                                          │\n";
 
         // LIVE GAP TIMES
@@ -812,7 +726,6 @@ void runRace(const Driver &playerDriver, const string &playerName, const Track &
         // Find player position
 
         int playerPos = field[playerIndex].currentPos;
-        double playerTime = field[playerIndex].cumulativeTime;
 
         // Show car ahead
 
@@ -822,9 +735,9 @@ void runRace(const Driver &playerDriver, const string &playerName, const Track &
             {
                 if (field[i].currentPos == playerPos - 1)
                 {
-                    double gap = field[i].cumulativeTime - playerTime;
-                    string status = (gap < 2.0) ? "← CATCHING " : "← STABLE";
-                    printf("│     P%d %-8s +%.1fs %-10s       │\n", playerPos - 1, field[i].displayName.substr(0, 8).c_str(), gap, status.c_str());
+                    double gap = p.gapAhead;
+                    string status = (gap < kDrsWindow) ? "← DRS     " : ((gap < 2.0) ? "← CATCHING " : "← STABLE");
+                    printf("│     P%d %-8.8s +%.1fs %-10s       │\n", playerPos - 1, field[i].displayName, gap, status.c_str());
                     break;
                 }
             }
@@ -842,9 +755,9 @@ void runRace(const Driver &playerDriver, const string &playerName, const Track &
             {
                 if (field[i].currentPos == playerPos + 1)
                 {
-                    double gap = playerTime - field[i].cumulativeTime;
-                    string status = (gap < 1.5) ? "← DEFEND! " : "← SAFE";
-                    printf("│     P%d %-8s -%.1fs %-10s         │\n", playerPos + 1, field[i].displayName.substr(0, 8).c_str(), gap, status.c_str());
+                    double gap = field[i].gapAhead;
+                    string status = (gap < kDrsWindow) ? "← DEFEND! " : "← SAFE";
+                    printf("│     P%d %-8.8s -%.1fs %-10s         │\n", playerPos + 1, field[i].displayName, gap, status.c_str());
                     break;
                 }
             }
@@ -858,7 +771,9 @@ void runRace(const Driver &playerDriver, const string &playerName, const Track &
 
         // RACE ENGINEER ADVICE
 
+        perfSwitch(perf, kPhaseRender, kPhaseText);
         string engineerAdvice = getEngineerAdvice(p, lap, totalLaps, playerPos, field);
+        perfSwitch(perf, kPhaseText, kPhaseRender);
         cout << "│    🎙️ ENGINEER ADVICE                     │\n";
 
         // Use multi-line display for engineer advice
@@ -919,7 +834,9 @@ void runRace(const Driver &playerDriver, const string &playerName, const Track &
 
         // Commentary
 
-        string comment = generateCommentary(p, lastPlayerPos, p.currentPos, p.tyre, p.inPitThisLap, lap, totalLaps, p.lastLapTime);
+        perfSwitch(perf, kPhaseRender, kPhaseText);
+        string comment = generateCommentary(p, flow.previousPosition(), p.currentPos, p.tyre, p.inPitThisLap, lap, totalLaps, p.lastLapTime);
+        perfSwitch(perf, kPhaseText, kPhaseRender);
 
         cout << "│    🎙️ ENGINEER                            │\n";
 
@@ -991,85 +908,65 @@ void runRace(const Driver &playerDriver, const string &playerName, const Track &
 
         // Strategy decision
 
-        bool isDecisionLap = (lap % 3 == 1); // Every 3 laps: 1, 4, 7, 10, 13, 16, 19, 22
         int playerAction = -1;
 
-        if (isDecisionLap)
+        if (wait == FlowWait::Decision)
         {
             cout << "│    💡 STRATEGY                           │\n";
             cout << "│    1. PUSH  🔥  (-0.5s, -8% tyres)       │\n";
             cout << "│    2. SAVE  🧊  (+0.3s, -3% tyres)       │\n";
             cout << "│    3. PIT   ⛽  (+" << track.pitStopTime << "s, fresh tyres)      │\n";
             cout << "│                                          │\n";
+            lookAhead.start(race);
+            for (int row = 0; row < LOOKAHEAD_ROWS; ++row)
+                cout << lookAheadLine(lookAhead, row) << "\n";
+            cout << "│                                          │\n";
             cout << "└──────────────────────────────────────────┘\n";
             cout << "Enter choice (1-3): ";
+            fflush(stdout);
+            perfEnd(perf, kPhaseRender);
+
+            // Panel, blank line, bottom border, prompt
+            atomic<bool> decided{false};
+            thread painter([&]()
+                           {
+                while (true)
+                {
+                    this_thread::sleep_for(chrono::milliseconds(LOOKAHEAD_REFRESH_MS));
+                    if (decided)
+                        break;
+                    redrawLookAhead(lookAhead, LOOKAHEAD_ROWS + 2);
+                } });
 
             string input;
             getline(cin, input);
+            decided = true;
+            lookAhead.stop();
+            painter.join();
             playerAction = clampVal(stoi(input), 1, 3);
-            if (playerAction == 1)
-                playerMode = 1;
-            else if (playerAction == 2)
-                playerMode = 0;
         }
         else
         {
             cout << "│  💡 STRATEGY: ";
-            if (playerMode == 1)
+            if (race.playerMode == 1)
                 cout << "PUSHING 🔥                 │\n";
-            else if (playerMode == 0)
+            else if (race.playerMode == 0)
                 cout << "SAVING 🧊                │\n";
             else
                 cout << "BALANCED ⚖️                 │\n";
             cout << "│                                          │\n";
             cout << "└──────────────────────────────────────────┘\n";
+            fflush(stdout);
+            perfEnd(perf, kPhaseRender);
             if (lap < totalLaps)
                 pressAnyKey();
         }
 
         // Simulate lap
 
-        for (int i = 0; i < fieldSize; ++i)
-        {
-            bool willPit = false;
-            if (i == playerIndex && isDecisionLap && playerAction == 3)
-                willPit = true;
-
-            int mode = (i == playerIndex) ? playerMode : aiChooseStrategy(field[i]);
-            if (i != playerIndex && field[i].tyre < 30.0)
-                willPit = true;
-
-            double lapTime = computeLapTimeSeconds(field[i], track, mode, i == playerIndex);
-
-            if (willPit)
-            {
-                lapTime += track.pitStopTime;
-                field[i].pitStops++;
-                field[i].inPitThisLap = true;
-            }
-            else
-            {
-                field[i].inPitThisLap = false;
-            }
-
-            field[i].lastLapTime = lapTime;
-            field[i].cumulativeTime += lapTime;
-
-            if (lapTime < field[i].fastestLap)
-                field[i].fastestLap = lapTime;
-            if (lapTime < fastestLapTime)
-            {
-                fastestLapTime = lapTime;
-                fastestLapHolder = field[i].displayName;
-            }
-
-            applyWearAndDamage(field[i], mode, willPit);
-        }
-
-        lastPlayerPos = field[playerIndex].currentPos;
-        recomputePositions(field);
+        wait = flow.resume(playerAction);
 
-        if (lap == totalLaps)
+        if (wait == FlowWait::Finished)
         {
             cout << "\nFinal lap complete! Race finished!\n";
             pressAnyKey();
@@ -1079,54 +976,32 @@ void runRace(const Driver &playerDriver, const string &playerName, const Track &
     // Results
 
     clearScreen();
-    cout << "┌──────────────────────────────────────────┐\n";
-    cout << "│          🏁 RACE CLASSIFICATION          │\n";
-    cout << "│          " << track.name;
-    for (int i = 0; i < 21 - track.name.length(); ++i)
-        cout << " ";
-    cout << "           │\n";
-    cout << "├──────────────────────────────────────────┤\n";
-    cout << "│                                          │\n";
-
-    // Create and sort indices properly
-    vector<int> idx(field.size());
-    for (int i = 0; i < field.size(); ++i)
     {
-        idx[i] = i;
+        ReportWriter report(stdout, 8192);
+        perfBegin(perf, kPhaseText);
+        writeClassification(report, race, "YOU");
+        if (endurance)
+            writeStintSummary(report, race.history[playerIndex]);
+        perfSwitch(perf, kPhaseText, kPhaseRender);
+        report.flush();
+        fflush(stdout);
+        perfEnd(perf, kPhaseRender);
     }
 
-    // Sort by cumulativeTime
-    sort(idx.begin(), idx.end(), [&](int a, int b)
-         { return field[a].cumulativeTime < field[b].cumulativeTime; });
+    // Keep the race in the local history alongside batch results
 
-    for (int p = 0; p < (int)idx.size(); ++p)
+    ResultsStore history;
+    if (history.open(RESULTS_DIR))
     {
-        int i = idx[p];
-        string medal = "  ";
-        if (p == 0)
-            medal = "🥇";
-        else if (p == 1)
-            medal = "🥈";
-        else if (p == 2)
-            medal = "🥉";
-
-        if (i == playerIndex)
-        {
-            printf("│     %s P%d. YOU%-15s%-9s   │\n", medal.c_str(), p + 1, "", formatTime(field[i].cumulativeTime).c_str());
-        }
-        else
-        {
-            printf("│     %s P%d. %-18s%-9s   │\n", medal.c_str(), p + 1, field[i].displayName.substr(0, 15).c_str(),
-                   formatTime(field[i].cumulativeTime).c_str());
-        }
+        StoredRace record;
+        storedRaceFrom(race, kRaceSourceHuman, 0, record);
+        history.append(record);
+    }
+    if (perf)
+    {
+        perf->raceDone();
+        writePerfReport(stdout, perf->totals, perf->error());
     }
-
-    cout << "│                                          │\n";
-    printf("│    🏅 Fastest Lap: %-12s (%-8s)    │\n", formatTime(fastestLapTime).c_str(), fastestLapHolder.substr(0, 8).c_str());
-    printf("│    🛞 Your Pit Stops: %-2d                 │\n", field[playerIndex].pitStops);
-    printf("│    📈 Position: P%d → P%-2d                 │\n", field[playerIndex].startingPos, field[playerIndex].currentPos);
-    cout << "│                                          │\n";
-    cout << "└──────────────────────────────────────────┘\n";
     pressAnyKey();
 }
 
@@ -1134,7 +1009,14 @@ void runRace(const Driver &playerDriver, const string &playerName, const Track &
 
 int main()
 {
+#ifdef _WIN32
     SetConsoleOutputCP(65001); // UTF-8 code page
+    DWORD consoleMode = 0;
+    HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
+    if (GetConsoleMode(console, &consoleMode))
+        SetConsoleMode(console, consoleMode | ENABLE_VIRTUAL_TERMINAL_PROCESSING); // cursor moves for the track map
+#endif
+    loadPolicyTable(aiPolicy, POLICY_FILE);
     while (true)
     {
         clearScreen();
@@ -1144,17 +1026,27 @@ int main()
         cout << "├─────────────────────────────────────┤\n";
         cout << "│                                     │\n";
         cout << "│   1. 🏁 QUICK RACE                  │\n";
-        cout << "│   2. 📖 ABOUT                       │\n";
-        cout << "│   3. ❌ EXIT                        │\n";
+        cout << "│   2. ⏱️ ENDURANCE RACE              │\n";
+        cout << "│   3. 📖 ABOUT                       │\n";
+        cout << "│   4. ❌ EXIT                        │\n";
         cout << "│                                     │\n";
         cout << "└─────────────────────────────────────┘\n";
-        cout << "Enter choice (1-3): ";
+        cout << "Enter choice (1-4): ";
 
         string input;
         getline(cin, input);
 
-        if (input == "1")
+        if (input == "1" || input == "2")
         {
+            bool endurance = input == "2";
+            int laps = kDefaultRaceLaps;
+            if (endurance)
+            {
+                cout << "Race length in laps (" << kDefaultRaceLaps << "-" << ENDURANCE_MAX_LAPS << "): ";
+                getline(cin, input);
+                laps = clampVal(stoi(input), kDefaultRaceLaps, ENDURANCE_MAX_LAPS);
+            }
+
             string team = getTeamSelection();
             if (team == "")
                 continue;
@@ -1163,17 +1055,17 @@ int main()
             if (driver.name == "")
                 continue;
 
-            string track = getTrackSelection();
+            string track = getTrackSelection(laps);
             if (track == "")
                 continue;
 
-            runRace(driver, driver.name, tracks[track]);
+            runRace(driver, driver.name, tracks[track], laps, endurance);
         }
-        else if (input == "2")
+        else if (input == "3")
         {
             showAbout();
         }
-        else if (input == "3")
+        else if (input == "4")
         {
             break;
         }
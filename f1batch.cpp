@@ -0,0 +1,569 @@
+// F1 TERMINAL RACER 2025 - BATCH ENGINE
+
+#include "f1batch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+using namespace std;
+
+// ---------- Batch Simulation ----------
+
+int resolveThreadCount(int threads)
+{
+    if (threads > 0)
+        return threads;
+    return max(1, (int)thread::hardware_concurrency());
+}
+
+void parallelFor(size_t count, int threads, const function<void(size_t, size_t)> &body)
+{
+    parallelForWorkers(count, threads, [&](int, size_t begin, size_t end) { body(begin, end); });
+}
+
+void parallelForWorkers(size_t count, int threads, const function<void(int, size_t, size_t)> &body)
+{
+    // Make sure the catalogs exist before workers read them
+    fieldSize();
+
+    // Workers claim small chunks so uneven race lengths still balance
+    const size_t chunk = 64;
+    atomic<size_t> next{0};
+
+    auto worker = [&](int index)
+    {
+        while (true)
+        {
+            size_t begin = next.fetch_add(chunk);
+            if (begin >= count)
+                break;
+            body(index, begin, min(count, begin + chunk));
+        }
+    };
+
+    int workers = (int)min<size_t>(resolveThreadCount(threads), (count + chunk - 1) / chunk);
+    if (workers <= 1)
+    {
+        worker(0);
+        return;
+    }
+
+    vector<thread> pool;
+    for (int t = 0; t < workers; ++t)
+        pool.emplace_back(worker, t);
+    for (auto &t : pool)
+        t.join();
+}
+
+size_t simulateBatch(const RaceScenario *scenarios, const uint64_t *seeds, size_t count,
+                     RaceResult *results, int *finishOrders, int threads)
+{
+    int stride = fieldSize();
+    atomic<size_t> failed{0};
+
+    parallelFor(count, threads, [&](size_t begin, size_t end)
+                {
+        size_t localFailed = 0;
+        for (size_t i = begin; i < end; ++i)
+        {
+            int *order = finishOrders ? finishOrders + i * stride : nullptr;
+            if (!simulateRace(scenarios[i], seeds[i], results[i], order))
+            {
+                results[i] = RaceResult();
+                if (order)
+                    fill(order, order + stride, 0);
+                ++localFailed;
+            }
+        }
+        failed += localFailed; });
+
+    return failed;
+}
+
+// ---------- Running Statistics ----------
+
+void RunningStat::add(double x)
+{
+    ++n;
+    double delta = x - mean;
+    mean += delta / n;
+    m2 += delta * (x - mean);
+}
+
+void RunningStat::merge(const RunningStat &other)
+{
+    if (other.n == 0)
+        return;
+    if (n == 0)
+    {
+        *this = other;
+        return;
+    }
+
+    long long total = n + other.n;
+    double delta = other.mean - mean;
+    mean += delta * other.n / total;
+    m2 += other.m2 + delta * delta * ((double)n * other.n / total);
+    n = total;
+}
+
+double RunningStat::variance() const
+{
+    return n > 1 ? m2 / (n - 1) : 0.0;
+}
+
+double RunningStat::standardError() const
+{
+    return n > 0 ? sqrt(variance() / n) : numeric_limits<double>::infinity();
+}
+
+double confidenceZ(double confidence)
+{
+    // Acklam's rational approximation of the inverse normal CDF
+    static const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                               1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+    static const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                               6.680131188771972e+01, -1.328068155288572e+01};
+    static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                               -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+    static const double d[] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                               3.754408661907416e+00};
+
+    double p = 1.0 - (1.0 - clampVal(confidence, 0.5, 0.999999)) / 2.0;
+    if (p > 1.0 - 0.02425)
+    {
+        double q = sqrt(-2.0 * log(1.0 - p));
+        return -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+               ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+    }
+
+    double q = p - 0.5;
+    double r = q * q;
+    return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+           (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+}
+
+// ---------- Batch Statistics ----------
+
+void BatchStats::add(const RaceResult &result)
+{
+    races++;
+    positionSum += result.playerPosition;
+    positionSqSum += (long long)result.playerPosition * result.playerPosition;
+    wins += (result.playerPosition == 1);
+    podiums += (result.playerPosition <= 3);
+    pitStops += result.playerPitStops;
+}
+
+void BatchStats::merge(const BatchStats &other)
+{
+    races += other.races;
+    positionSum += other.positionSum;
+    positionSqSum += other.positionSqSum;
+    wins += other.wins;
+    podiums += other.podiums;
+    pitStops += other.pitStops;
+}
+
+double BatchStats::meanPosition() const
+{
+    return races ? (double)positionSum / races : 0.0;
+}
+
+double BatchStats::positionStdError() const
+{
+    if (races < 2)
+        return 0.0;
+    double mean = meanPosition();
+    double variance = ((double)positionSqSum - races * mean * mean) / (races - 1);
+    return sqrt(max(variance, 0.0) / races);
+}
+
+double BatchStats::winRate() const
+{
+    return races ? (double)wins / races : 0.0;
+}
+
+BatchStats simulateSeedRange(const RaceScenario &scenario, uint64_t seedBegin, uint64_t seedEnd)
+{
+    BatchStats stats;
+    RaceResult result;
+    for (uint64_t seed = seedBegin; seed < seedEnd; ++seed)
+    {
+        if (simulateRace(scenario, seed, result))
+            stats.add(result);
+    }
+    return stats;
+}
+
+// ---------- Adaptive Comparison ----------
+
+static double intervalHalfWidth(const RunningStat &stat, AdaptiveMetric metric, double z)
+{
+    if (stat.n == 0)
+        return numeric_limits<double>::infinity();
+    if (metric == AdaptiveMetric::WinProbability)
+    {
+        // Agresti-Coull keeps 0% / 100% win rates from collapsing to zero width
+        double n = stat.n + z * z;
+        double p = (stat.mean * stat.n + z * z / 2.0) / n;
+        return z * sqrt(p * (1.0 - p) / n);
+    }
+    return z * stat.standardError();
+}
+
+AdaptiveReport compareStrategiesAdaptive(const RaceScenario &base, const vector<string_view> &strategies,
+                                         const AdaptiveOptions &options)
+{
+    AdaptiveReport report;
+    int count = (int)strategies.size();
+    report.estimates.resize(count);
+    for (int i = 0; i < count; ++i)
+        report.estimates[i].strategy = strategies[i];
+    if (count == 0)
+        return report;
+
+    // A failed race comes back as P0, which would look better than a win
+    RaceResult probe;
+    if (!simulateRace(base, options.seedBase, probe))
+    {
+        report.scenarioError = true;
+        return report;
+    }
+
+    auto &est = report.estimates;
+    double z = confidenceZ(options.confidence);
+    double sign = (options.metric == AdaptiveMetric::FinishPosition) ? 1.0 : -1.0; // lower score is better
+    int minRaces = max(options.minRaces, 2);
+    int waveSize = max(options.waveSize, 1);
+
+    vector<RaceScenario> scenarios;
+    vector<uint64_t> seeds;
+    vector<int> owner;
+    vector<RaceResult> results;
+
+    while (report.totalRaces < options.maxRaces)
+    {
+        // Plan the wave: fill minimum samples first, then favour wide intervals
+
+        long long budget = min<long long>(waveSize, options.maxRaces - report.totalRaces);
+        vector<long long> share(count, 0), need(count, 0);
+        double widthSum = 0.0;
+        for (int i = 0; i < count; ++i)
+        {
+            if (est[i].dominated)
+                continue;
+            if (est[i].stat.n < minRaces)
+                need[i] = minRaces - est[i].stat.n;
+            else
+                widthSum += est[i].halfWidth;
+        }
+
+        // Short strategies take the budget a race at a time in turn, so
+        // together they never ask for more than the wave holds
+        long long reserved = 0;
+        for (bool handed = true; handed && reserved < budget;)
+        {
+            handed = false;
+            for (int i = 0; i < count && reserved < budget; ++i)
+            {
+                if (share[i] < need[i])
+                {
+                    share[i]++;
+                    reserved++;
+                    handed = true;
+                }
+            }
+        }
+
+        // Proportional shares are rounded down and the races left over go
+        // to the widest intervals, so the wave is exactly the budget
+        long long remaining = budget - reserved;
+        if (remaining > 0 && widthSum > 0.0)
+        {
+            vector<int> judged;
+            long long given = 0;
+            for (int i = 0; i < count; ++i)
+            {
+                if (est[i].dominated || est[i].stat.n < minRaces)
+                    continue;
+                share[i] = (long long)(remaining * (est[i].halfWidth / widthSum));
+                given += share[i];
+                judged.push_back(i);
+            }
+            stable_sort(judged.begin(), judged.end(),
+                        [&](int a, int b) { return est[a].halfWidth > est[b].halfWidth; });
+            for (size_t k = 0; given < remaining; k = (k + 1) % judged.size(), ++given)
+                share[judged[k]]++;
+        }
+
+        scenarios.clear();
+        seeds.clear();
+        owner.clear();
+        for (int i = 0; i < count; ++i)
+        {
+            RaceScenario scenario = base;
+            scenario.strategy = strategies[i];
+            for (long long k = 0; k < share[i]; ++k)
+            {
+                scenarios.push_back(scenario);
+                seeds.push_back(options.seedBase + (uint64_t)(est[i].stat.n + k));
+                owner.push_back(i);
+            }
+        }
+        if (scenarios.empty())
+            break;
+
+        results.assign(scenarios.size(), RaceResult());
+        if (simulateBatch(scenarios.data(), seeds.data(), scenarios.size(), results.data(), nullptr, options.threads) > 0)
+        {
+            report.scenarioError = true;
+            break;
+        }
+
+        for (size_t r = 0; r < results.size(); ++r)
+        {
+            double value = (options.metric == AdaptiveMetric::FinishPosition)
+                               ? (double)results[r].playerPosition
+                               : (results[r].playerPosition == 1 ? 1.0 : 0.0);
+            est[owner[r]].stat.add(value);
+        }
+        report.totalRaces += (long long)results.size();
+        report.waves++;
+
+        // Re-rank, retire dominated strategies and test the stopping rules
+
+        report.leader = -1;
+        for (int i = 0; i < count; ++i)
+        {
+            est[i].halfWidth = intervalHalfWidth(est[i].stat, options.metric, z);
+            if (!est[i].dominated && (report.leader < 0 || sign * est[i].stat.mean < sign * est[report.leader].stat.mean))
+                report.leader = i;
+        }
+
+        const StrategyEstimate &lead = est[report.leader];
+        bool judged = lead.stat.n >= minRaces;
+        report.separated = judged && count > 1;
+        report.precise = true;
+        for (int i = 0; i < count; ++i)
+        {
+            if (i == report.leader)
+                continue;
+            bool ready = judged && est[i].stat.n >= minRaces;
+            double leadWorst = sign * lead.stat.mean + lead.halfWidth;
+            double otherBest = sign * est[i].stat.mean - est[i].halfWidth;
+            if (ready && otherBest > leadWorst)
+                est[i].dominated = true;
+            if (!est[i].dominated)
+            {
+                report.separated = false;
+                if (est[i].halfWidth > options.precision)
+                    report.precise = false;
+            }
+        }
+        if (lead.halfWidth > options.precision)
+            report.precise = false;
+
+        if (report.separated || report.precise)
+            break;
+    }
+
+    return report;
+}
+
+// ---------- Paired Comparison ----------
+
+// Fills halfWidth and varianceRatio; unitRaces is what one diff sample costs
+static void finishPairedStat(PairedStat &stat, int unitRaces, double z)
+{
+    stat.halfWidth = z * stat.diff.standardError();
+    // An unpaired run with the same budget has variance 2 (var a + var b) / races,
+    // the paired one unitRaces var diff / races
+    double paired = unitRaces * stat.diff.variance();
+    stat.varianceRatio = paired > 0.0 ? 2.0 * (stat.a.variance() + stat.b.variance()) / paired
+                                      : numeric_limits<double>::infinity();
+}
+
+PairedReport compareStrategiesPaired(const RaceScenario &base, string_view a, string_view b,
+                                     const PairedOptions &options)
+{
+    PairedReport report;
+    bool antithetic = options.commonDraws && options.antithetic;
+    int runsPerUnit = antithetic ? 2 : 1;
+    size_t units = (size_t)max<long long>(options.races / runsPerUnit, 2);
+
+    // Per unit and run: a's and b's position and time, kept in index order so
+    // the statistics never depend on scheduling
+    struct Outcome
+    {
+        double positionA, positionB, timeA, timeB;
+    };
+    vector<Outcome> outcomes(units * runsPerUnit);
+    atomic<size_t> failed{0};
+
+    parallelFor(units, options.threads, [&](size_t begin, size_t end)
+                {
+        size_t localFailed = 0;
+        RaceScenario sa = base, sb = base;
+        sa.strategy = a;
+        sb.strategy = b;
+        sa.commonDraws = sb.commonDraws = options.commonDraws;
+        RaceResult ra, rb;
+        for (size_t k = begin; k < end; ++k)
+        {
+            uint64_t seed = options.seedBase + k;
+            for (int run = 0; run < runsPerUnit; ++run)
+            {
+                sa.antithetic = sb.antithetic = (run == 1);
+                bool ok = simulateRace(sa, seed, ra);
+                // Unpaired: b gets seeds of its own, well clear of a's
+                ok = simulateRace(sb, options.commonDraws ? seed : seed + (1ull << 40), rb) && ok;
+                if (!ok)
+                    ++localFailed;
+                outcomes[k * runsPerUnit + run] = {(double)ra.playerPosition, (double)rb.playerPosition,
+                                                   ra.playerTime, rb.playerTime};
+            }
+        }
+        failed += localFailed; });
+
+    // A failed race comes back as P0 in 0 s, which would poison every statistic
+    if (failed)
+    {
+        report.scenarioError = true;
+        return report;
+    }
+
+    for (size_t k = 0; k < units; ++k)
+    {
+        double positionDiff = 0.0, timeDiff = 0.0;
+        for (int run = 0; run < runsPerUnit; ++run)
+        {
+            const Outcome &o = outcomes[k * runsPerUnit + run];
+            report.position.a.add(o.positionA);
+            report.position.b.add(o.positionB);
+            report.raceTime.a.add(o.timeA);
+            report.raceTime.b.add(o.timeB);
+            positionDiff += o.positionB - o.positionA;
+            timeDiff += o.timeB - o.timeA;
+        }
+        report.position.diff.add(positionDiff / runsPerUnit);
+        report.raceTime.diff.add(timeDiff / runsPerUnit);
+    }
+
+    double z = confidenceZ(options.confidence);
+    finishPairedStat(report.position, 2 * runsPerUnit, z);
+    finishPairedStat(report.raceTime, 2 * runsPerUnit, z);
+    report.races = (long long)outcomes.size() * 2;
+    return report;
+}
+
+// ---------- Setup Optimizer ----------
+
+// Mean race time of each candidate over seeds [seedBase, seedBase + races),
+// every candidate on the same draws. Empty if base cannot be raced.
+static vector<double> scoreSetups(const RaceScenario &base, const vector<CarSetup> &candidates, int races,
+                                  const SetupSearchOptions &options)
+{
+    vector<double> times(candidates.size() * races);
+    atomic<size_t> failed{0};
+    parallelFor(times.size(), options.threads, [&](size_t begin, size_t end)
+                {
+        RaceScenario scenario = base;
+        scenario.commonDraws = true;
+        RaceResult result;
+        size_t localFailed = 0;
+        for (size_t i = begin; i < end; ++i)
+        {
+            scenario.setup = &candidates[i / races];
+            if (!simulateRace(scenario, options.seedBase + i % races, result))
+                ++localFailed;
+            times[i] = result.playerTime;
+        }
+        failed += localFailed; });
+    if (failed)
+        return {};
+
+    // Summed in index order so the result never depends on scheduling
+    vector<double> means(candidates.size(), 0.0);
+    for (size_t c = 0; c < candidates.size(); ++c)
+    {
+        for (int k = 0; k < races; ++k)
+            means[c] += times[c * races + k];
+        means[c] /= races;
+    }
+    return means;
+}
+
+SetupSearchResult optimizeSetup(const RaceScenario &base, const SetupSearchOptions &options)
+{
+    SetupSearchResult out;
+    auto &trackList = trackCatalog();
+    if (base.track < 0 || base.track >= (int)trackList.size())
+        return out;
+
+    int races = max(options.racesPerCandidate, 1);
+    int steps = max(options.gridSteps, 2);
+    double step = 1.0 / (steps - 1);
+
+    // Coarse pass over the whole cube, plus the baseline for reference
+
+    vector<CarSetup> candidates;
+    candidates.push_back(baselineSetup(*trackList[base.track]));
+    for (int d = 0; d < steps; ++d)
+        for (int g = 0; g < steps; ++g)
+            for (int p = 0; p < steps; ++p)
+                candidates.push_back({d * step, g * step, p * step});
+
+    vector<double> means = scoreSetups(base, candidates, races, options);
+    if (means.empty())
+    {
+        out.scenarioError = true;
+        return out;
+    }
+    out.baselineTime = means[0];
+    size_t bestIndex = min_element(means.begin(), means.end()) - means.begin();
+    out.best = candidates[bestIndex];
+    out.bestTime = means[bestIndex];
+    out.candidates = (int)candidates.size();
+
+    // Refine on a shrinking neighbourhood of the best setup
+
+    for (int round = 0; round < options.refineRounds; ++round)
+    {
+        step *= 0.5;
+        candidates.clear();
+        for (int dd = -1; dd <= 1; ++dd)
+            for (int dg = -1; dg <= 1; ++dg)
+                for (int dp = -1; dp <= 1; ++dp)
+                {
+                    if (dd == 0 && dg == 0 && dp == 0)
+                        continue;
+                    CarSetup c = {clampVal(out.best.downforce + dd * step, 0.0, 1.0),
+                                  clampVal(out.best.gearing + dg * step, 0.0, 1.0),
+                                  clampVal(out.best.tyrePressure + dp * step, 0.0, 1.0)};
+                    candidates.push_back(c);
+                }
+
+        means = scoreSetups(base, candidates, races, options);
+        if (means.empty())
+        {
+            out.scenarioError = true;
+            return out;
+        }
+        out.candidates += (int)candidates.size();
+        for (size_t c = 0; c < candidates.size(); ++c)
+        {
+            if (means[c] < out.bestTime)
+            {
+                out.bestTime = means[c];
+                out.best = candidates[c];
+            }
+        }
+    }
+
+    out.races = (long long)out.candidates * races;
+    return out;
+}
@@ -0,0 +1,180 @@
+// F1 TERMINAL RACER 2025 - BATCH ENGINE
+// Runs many headless races across worker threads.
+
+#ifndef F1BATCH_H
+#define F1BATCH_H
+
+#include "f1sim.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+// ---------- Batch Simulation ----------
+
+int resolveThreadCount(int threads);
+
+// Calls body(begin, end) over [0, count) in chunks claimed by worker threads.
+void parallelFor(std::size_t count, int threads, const std::function<void(std::size_t, std::size_t)> &body);
+// Same, passing the worker index (0 .. resolveThreadCount(threads) - 1) for
+// per-worker state such as progress rings.
+void parallelForWorkers(std::size_t count, int threads, const std::function<void(int, std::size_t, std::size_t)> &body);
+
+// Simulates scenarios[i] with seeds[i] into results[i]. finishOrders, when
+// given, holds count * fieldSize() driver ids. threads <= 0 uses every core.
+// Returns the number of races that failed validation; their results and
+// finish orders are zeroed.
+std::size_t simulateBatch(const RaceScenario *scenarios, const std::uint64_t *seeds, std::size_t count,
+                          RaceResult *results, int *finishOrders, int threads);
+
+// ---------- Running Statistics ----------
+
+// Welford accumulator; merge() combines partial results from other workers.
+struct RunningStat
+{
+    long long n = 0;
+    double mean = 0.0, m2 = 0.0;
+
+    void add(double x);
+    void merge(const RunningStat &other);
+    double variance() const;
+    double standardError() const;
+};
+
+// Two-sided normal quantile, e.g. 0.95 -> 1.96.
+double confidenceZ(double confidence);
+
+// ---------- Batch Statistics ----------
+
+// Player outcome totals for one scenario. Integer sums only, so partial
+// results from threads, processes or cached seed ranges merge to the same
+// bits in any order. Trivially copyable for the wire and on-disk caches.
+struct BatchStats
+{
+    long long races = 0, positionSum = 0, positionSqSum = 0;
+    long long wins = 0, podiums = 0, pitStops = 0;
+
+    void add(const RaceResult &result);
+    void merge(const BatchStats &other);
+    double meanPosition() const;
+    double positionStdError() const;
+    double winRate() const;
+};
+
+// Runs seeds [seedBegin, seedEnd) of one scenario on the calling thread.
+BatchStats simulateSeedRange(const RaceScenario &scenario, std::uint64_t seedBegin, std::uint64_t seedEnd);
+
+// ---------- Adaptive Comparison ----------
+
+enum class AdaptiveMetric
+{
+    FinishPosition, // expected player finishing position, lower is better
+    WinProbability  // player win rate, higher is better
+};
+
+struct AdaptiveOptions
+{
+    AdaptiveMetric metric = AdaptiveMetric::FinishPosition;
+    double precision = 0.1;     // target confidence-interval half-width
+    double confidence = 0.95;
+    int waveSize = 512;         // races per wave across all active strategies
+    int minRaces = 128;         // per strategy before it can be judged
+    long long maxRaces = 1000000; // total budget across strategies
+    int threads = 0;
+    std::uint64_t seedBase = 0;
+};
+
+struct StrategyEstimate
+{
+    std::string_view strategy;
+    RunningStat stat;
+    double halfWidth = 0.0;
+    bool dominated = false;
+};
+
+struct AdaptiveReport
+{
+    std::vector<StrategyEstimate> estimates;
+    int leader = -1;
+    bool separated = false;     // leader's interval clears every other strategy
+    bool precise = false;       // every surviving interval meets the precision
+    bool scenarioError = false; // base could not be raced; nothing was estimated
+    long long totalRaces = 0;
+    int waves = 0;
+};
+
+// Runs races in waves until the intervals are tight enough or the leader is
+// separated. Strategies whose interval is entirely worse than the leader's
+// stop receiving races; the rest of each wave goes to the widest intervals.
+// A wave never holds more than waveSize races, nor the run maxRaces.
+// Race k of every strategy uses seed seedBase + k. A base scenario that
+// simulateRace rejects sets scenarioError and runs no waves.
+AdaptiveReport compareStrategiesAdaptive(const RaceScenario &base, const std::vector<std::string_view> &strategies,
+                                         const AdaptiveOptions &options);
+
+// ---------- Paired Comparison ----------
+
+struct PairedOptions
+{
+    long long races = 2000;     // per strategy, both halves of an antithetic pair included
+    bool commonDraws = true;    // false gives each strategy its own seeds, as a reference
+    bool antithetic = false;    // with commonDraws, also run every seed mirrored
+    double confidence = 0.95;
+    int threads = 0;
+    std::uint64_t seedBase = 0;
+};
+
+// a and b are per race. diff is b - a per unit: one race of each strategy,
+// or with antithetic the mean over a seed and its mirror.
+struct PairedStat
+{
+    RunningStat a, b, diff;
+    double halfWidth = 0.0;     // of the mean difference
+    double varianceRatio = 0.0; // unpaired races needed per paired race for the same width
+};
+
+struct PairedReport
+{
+    PairedStat position, raceTime;
+    long long races = 0;        // across both strategies
+    bool scenarioError = false; // base could not be raced; nothing was estimated
+};
+
+// Runs strategies a and b for the player against the same random draws for
+// every car and lap (see RaceState::commonDraws). Luck then cancels in the
+// difference, which needs far fewer races for a given interval than two
+// separate estimates. Seed k of the run is seedBase + k. A base scenario
+// that simulateRace rejects sets scenarioError.
+PairedReport compareStrategiesPaired(const RaceScenario &base, std::string_view a, std::string_view b,
+                                     const PairedOptions &options);
+
+// ---------- Setup Optimizer ----------
+
+struct SetupSearchOptions
+{
+    int racesPerCandidate = 200;
+    int gridSteps = 5;          // per knob on the first, coarse pass
+    int refineRounds = 3;       // each halves the step around the best so far
+    int threads = 0;
+    std::uint64_t seedBase = 0;
+};
+
+struct SetupSearchResult
+{
+    CarSetup best;
+    double bestTime = 0.0;      // mean player race time in seconds
+    double baselineTime = 0.0;  // same seeds with baselineSetup
+    int candidates = 0;
+    long long races = 0;
+    bool scenarioError = false; // base could not be raced; nothing was searched
+};
+
+// Grid search then local refinement over the player's car setup, scored by
+// mean race time. Every candidate runs the same seeds on common draws, so the
+// comparison is not drowned by race-to-race noise. Candidates are evaluated
+// in parallel. A base scenario that simulateRace rejects sets scenarioError.
+SetupSearchResult optimizeSetup(const RaceScenario &base, const SetupSearchOptions &options);
+
+#endif
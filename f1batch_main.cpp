@@ -0,0 +1,1171 @@
+// F1 TERMINAL RACER 2025 - BATCH TOOL
+// Command-line front end for the headless engine.
+
+#include "f1batch.h"
+#include "f1broadcast.h"
+#include "f1cache.h"
+#include "f1dashboard.h"
+#include "f1flow.h"
+#include "f1perf.h"
+#include "f1policy.h"
+#include "f1rating.h"
+#include "f1report.h"
+#include "f1scenario.h"
+#include "f1shard.h"
+#include "f1store.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// ---------- Arguments ----------
+
+struct Args
+{
+    int argc;
+    char **argv;
+
+    const char *option(const char *name, const char *fallback = nullptr) const
+    {
+        for (int i = 2; i + 1 < argc; ++i)
+        {
+            if (strcmp(argv[i], name) == 0)
+                return argv[i + 1];
+        }
+        return fallback;
+    }
+
+    long long number(const char *name, long long fallback) const
+    {
+        const char *v = option(name);
+        return v ? atoll(v) : fallback;
+    }
+
+    bool flag(const char *name) const
+    {
+        for (int i = 2; i < argc; ++i)
+        {
+            if (strcmp(argv[i], name) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    // First argument after the command that is not an option
+    const char *positional() const
+    {
+        for (int i = 2; i < argc; ++i)
+        {
+            if (argv[i][0] == '-' && argv[i][1] == '-')
+            {
+                ++i;
+                continue;
+            }
+            return argv[i];
+        }
+        return nullptr;
+    }
+};
+
+static double secondsSince(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Track, driver, strategy, laps and policy shared by the race commands
+static bool scenarioFromArgs(const Args &args, RaceScenario &scenario, PolicyTable &policy)
+{
+    scenario.track = findTrack(args.option("--track", "Monaco"));
+    scenario.playerDriver = findDriver(args.option("--driver", "Max Verstappen"));
+    scenario.totalLaps = (int)args.number("--laps", kDefaultRaceLaps);
+    scenario.strategy = args.option("--strategy", "");
+    if (scenario.track < 0 || scenario.playerDriver < 0 || scenario.totalLaps <= 0)
+    {
+        fprintf(stderr, "unknown --track or --driver, or bad --laps\n");
+        return false;
+    }
+
+    if (const char *path = args.option("--policy"))
+    {
+        if (!loadPolicyTable(policy, path))
+        {
+            fprintf(stderr, "could not load policy table %s\n", path);
+            return false;
+        }
+        scenario.policy = &policy;
+    }
+    return true;
+}
+
+// Splits "a,b,c"; "all" expands to every catalog entry
+static vector<string> listOption(const Args &args, const char *name, const char *fallback, const vector<string> &all)
+{
+    string text = args.option(name, fallback);
+    if (text == "all")
+        return all;
+
+    vector<string> items;
+    size_t start = 0;
+    while (start <= text.size())
+    {
+        size_t comma = text.find(',', start);
+        if (comma == string::npos)
+            comma = text.size();
+        items.push_back(text.substr(start, comma - start));
+        start = comma + 1;
+    }
+    return items;
+}
+
+// "A-B" is seeds [A, B); a single number N means [0, N)
+static void seedRange(const Args &args, uint64_t &begin, uint64_t &end)
+{
+    string text = args.option("--seeds", "0-10000");
+    size_t dash = text.find('-');
+    begin = (dash == string::npos) ? 0 : strtoull(text.c_str(), nullptr, 10);
+    end = strtoull(text.c_str() + (dash == string::npos ? 0 : dash + 1), nullptr, 10);
+}
+
+// --perf: one counter group per worker thread, opened from that thread on
+// first use. Empty when counting is off.
+typedef vector<unique_ptr<PerfCounters>> WorkerPerf;
+
+static PerfCounters *workerPerf(WorkerPerf &perf, int worker)
+{
+    if (perf.empty())
+        return nullptr;
+    if (!perf[worker])
+    {
+        perf[worker] = make_unique<PerfCounters>();
+        perf[worker]->open();
+    }
+    return perf[worker].get();
+}
+
+static void reportPerf(FILE *out, const WorkerPerf &perf, const PerfCounters *extra = nullptr)
+{
+    PerfTotals totals;
+    string error;
+    for (auto &p : perf)
+    {
+        if (!p)
+            continue;
+        totals.merge(p->totals);
+        if (error.empty())
+            error = p->error();
+    }
+    if (extra)
+    {
+        PerfTotals more = extra->totals;
+        more.races = 0; // same races, other phases
+        totals.merge(more);
+    }
+    writePerfReport(out, totals, error);
+}
+
+// ---------- Commands ----------
+
+static int cmdRun(const Args &args)
+{
+    RaceScenario scenario;
+    PolicyTable policy;
+    if (!scenarioFromArgs(args, scenario, policy))
+        return 2;
+
+    long long races = args.number("--races", 10000);
+    uint64_t seed = (uint64_t)args.number("--seed", 1);
+    int threads = (int)args.number("--threads", 0);
+
+    ResultsStore store;
+    const char *storeDir = args.option("--store");
+    if (storeDir && !store.open(storeDir))
+    {
+        fprintf(stderr, "could not open results store %s\n", storeDir);
+        return 1;
+    }
+
+    mutex merge;
+    RunningStat playerPos;
+    vector<long long> wins(driverCatalog().size(), 0);
+    bool storeOk = true;
+
+    WorkerPerf perf(args.flag("--perf") ? resolveThreadCount(threads) : 0);
+    unique_ptr<ProgressDashboard> dashboard;
+    if (args.flag("--dashboard"))
+    {
+        dashboard = make_unique<ProgressDashboard>(resolveThreadCount(threads), races, scenario.playerDriver);
+        dashboard->start();
+    }
+
+    auto start = chrono::steady_clock::now();
+    parallelForWorkers((size_t)races, threads, [&](int worker, size_t begin, size_t end)
+                {
+        auto chunkStart = chrono::steady_clock::now();
+        ProgressRecord progress;
+        RunningStat localPos;
+        vector<long long> localWins(wins.size(), 0);
+        vector<StoredRace> stored;
+        RaceState race;
+        race.perf = workerPerf(perf, worker);
+        RaceResult result;
+        for (size_t i = begin; i < end; ++i)
+        {
+            simulateRace(scenario, seed + i, race);
+            if (race.perf)
+                race.perf->raceDone();
+            summariseRace(race, result);
+            localPos.add(result.playerPosition);
+            localWins[result.winnerDriver]++;
+            if (result.winnerDriver < kProgressDrivers)
+                progress.wins[result.winnerDriver]++;
+            if (store.isOpen())
+            {
+                stored.emplace_back();
+                storedRaceFrom(race, kRaceSourceBatch, seed + i, stored.back());
+            }
+        }
+
+        if (dashboard)
+        {
+            progress.races = (uint32_t)(end - begin);
+            progress.busyNanos = (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - chunkStart).count();
+            dashboard->publish(worker, progress);
+        }
+
+        lock_guard<mutex> lock(merge);
+        playerPos.merge(localPos);
+        for (size_t d = 0; d < wins.size(); ++d)
+            wins[d] += localWins[d];
+        for (auto &r : stored)
+            storeOk = store.append(r) && storeOk; });
+    double elapsed = secondsSince(start);
+    if (dashboard)
+        dashboard->stop();
+
+    if (store.isOpen() && !store.close())
+        storeOk = false;
+
+    auto &drivers = driverCatalog();
+    printf("%lld races in %.2fs (%.0f races/s)\n", races, elapsed, races / max(elapsed, 1e-9));
+    printf("%s: mean finish P%.3f +/- %.3f, win rate %.1f%%\n", drivers[scenario.playerDriver]->name.c_str(),
+           playerPos.mean, confidenceZ(0.95) * playerPos.standardError(),
+           100.0 * wins[scenario.playerDriver] / max(races, 1LL));
+    for (size_t d = 0; d < wins.size(); ++d)
+    {
+        if (wins[d] > 0)
+            printf("  %-18s %6.2f%% wins\n", drivers[d]->name.c_str(), 100.0 * wins[d] / races);
+    }
+    if (!perf.empty())
+        reportPerf(stdout, perf);
+    if (!storeOk)
+    {
+        fprintf(stderr, "writing to results store %s failed\n", storeDir);
+        return 1;
+    }
+    return 0;
+}
+
+static int cmdSweep(const Args &args)
+{
+    vector<string> allTracks, allDrivers;
+    for (auto &track : tracks)
+        allTracks.push_back(track.first);
+    for (auto *driver : driverCatalog())
+        allDrivers.push_back(driver->name);
+
+    vector<string> trackNames = listOption(args, "--tracks", "all", allTracks);
+    vector<string> driverNames = listOption(args, "--drivers", "Max Verstappen", allDrivers);
+    vector<string> strategies = listOption(args, "--strategies", "", {});
+
+    PolicyTable policy;
+    const char *policyPath = args.option("--policy");
+    if (policyPath && !loadPolicyTable(policy, policyPath))
+    {
+        fprintf(stderr, "could not load policy table %s\n", policyPath);
+        return 2;
+    }
+
+    vector<RaceScenario> scenarios;
+    for (auto &trackName : trackNames)
+        for (auto &driverName : driverNames)
+            for (auto &strategy : strategies)
+            {
+                RaceScenario scenario;
+                scenario.track = findTrack(trackName);
+                scenario.playerDriver = findDriver(driverName);
+                scenario.totalLaps = (int)args.number("--laps", kDefaultRaceLaps);
+                scenario.strategy = strategy;
+                scenario.policy = policyPath ? &policy : nullptr;
+                if (scenario.track < 0 || scenario.playerDriver < 0)
+                {
+                    fprintf(stderr, "unknown track %s or driver %s\n", trackName.c_str(), driverName.c_str());
+                    return 2;
+                }
+                scenarios.push_back(scenario);
+            }
+
+    SweepOptions options;
+    options.workers = (int)args.number("--workers", 0);
+    options.shardSize = (uint64_t)args.number("--shard-size", (long long)options.shardSize);
+    options.killAfterShards = (int)args.number("--kill-after", -1);
+    seedRange(args, options.seedBegin, options.seedEnd);
+
+    auto start = chrono::steady_clock::now();
+    SweepReport report;
+    bool ok = runShardedSweep(scenarios, options, report);
+    double elapsed = secondsSince(start);
+
+    long long races = 0;
+    for (size_t i = 0; i < scenarios.size(); ++i)
+    {
+        const BatchStats &stats = report.perScenario[i];
+        races += stats.races;
+        printf("%-12s %-18s %-12s %8lld races  P%6.3f +/- %.3f  win %5.1f%%\n",
+               trackNames[i / (driverNames.size() * strategies.size())].c_str(),
+               driverNames[i / strategies.size() % driverNames.size()].c_str(),
+               strategies[i % strategies.size()].empty() ? "-" : strategies[i % strategies.size()].c_str(),
+               stats.races, stats.meanPosition(), confidenceZ(0.95) * stats.positionStdError(), 100.0 * stats.winRate());
+    }
+    printf("%lld races in %lld shards, %.2fs (%.0f races/s), %d worker failure(s)%s\n", races, report.shards, elapsed,
+           races / max(elapsed, 1e-9), report.workerFailures, ok ? "" : ", INCOMPLETE");
+    return ok ? 0 : 1;
+}
+
+static int cmdStoreQuery(const Args &args)
+{
+    const char *dir = args.positional();
+    if (!dir)
+    {
+        fprintf(stderr, "usage: f1batch store-query <dir> [--driver NAME | --team KEY] [--track KEY]\n");
+        return 2;
+    }
+
+    auto openStart = chrono::steady_clock::now();
+    ResultsStore store;
+    if (!store.open(dir))
+    {
+        fprintf(stderr, "could not open results store %s\n", dir);
+        return 1;
+    }
+    double openSecs = secondsSince(openStart);
+
+    int track = -1;
+    if (const char *name = args.option("--track"))
+    {
+        track = findTrack(name);
+        if (track < 0)
+        {
+            fprintf(stderr, "unknown track %s\n", name);
+            return 2;
+        }
+    }
+
+    auto queryStart = chrono::steady_clock::now();
+    StandingStats stats;
+    string subject;
+    if (const char *name = args.option("--team"))
+    {
+        int team = findTeam(name);
+        if (team < 0)
+        {
+            fprintf(stderr, "unknown team %s\n", name);
+            return 2;
+        }
+        stats = store.teamStats(team, track);
+        subject = name;
+    }
+    else if (const char *name = args.option("--driver"))
+    {
+        int driver = findDriver(name);
+        if (driver < 0)
+        {
+            fprintf(stderr, "unknown driver %s\n", name);
+            return 2;
+        }
+        stats = store.driverStats(driver, track);
+        subject = name;
+    }
+    else
+    {
+        printf("%llu races stored (opened in %.1f ms)\n", (unsigned long long)store.raceCount(), openSecs * 1e3);
+        for (int t = 0; t < (int)trackCatalog().size(); ++t)
+            printf("  %-28s %zu races\n", trackCatalog()[t]->name.c_str(), store.racesAtTrack(t).size());
+        return 0;
+    }
+    double querySecs = secondsSince(queryStart);
+
+    printf("%s at %s: %lld starts, %.1f%% wins, %.1f%% podiums, mean P%.2f\n", subject.c_str(),
+           track < 0 ? "all tracks" : trackCatalog()[track]->name.c_str(), stats.starts, 100.0 * stats.winRate(),
+           100.0 * stats.podiumRate(), stats.meanPosition());
+    printf("(%llu races, opened in %.1f ms, query %.1f us)\n", (unsigned long long)store.raceCount(), openSecs * 1e3,
+           querySecs * 1e6);
+    return 0;
+}
+
+
+static int cmdPolicyBuild(const Args &args)
+{
+    const char *path = args.positional();
+    if (!path)
+    {
+        fprintf(stderr, "usage: f1batch policy-build <file> [--rollouts N] [--laps N] [--threads N] [--seed N]\n");
+        return 2;
+    }
+
+    PolicyBuildOptions options;
+    options.rollouts = (int)args.number("--rollouts", options.rollouts);
+    options.totalLaps = (int)args.number("--laps", options.totalLaps);
+    options.threads = (int)args.number("--threads", options.threads);
+    options.seed = (uint64_t)args.number("--seed", (long long)options.seed);
+
+    auto start = chrono::steady_clock::now();
+    PolicyTable table;
+    buildPolicyTable(table, options);
+    if (!savePolicyTable(table, path))
+    {
+        fprintf(stderr, "could not write %s\n", path);
+        return 1;
+    }
+    printf("Built %zu policy cells for %d tracks x %d drivers in %.1fs -> %s\n",
+           table.actions.size(), table.trackCount, table.driverCount, secondsSince(start), path);
+    return 0;
+}
+
+static int cmdBroadcast(const Args &args)
+{
+    RaceScenario scenario;
+    PolicyTable policy;
+    if (!scenarioFromArgs(args, scenario, policy))
+        return 2;
+
+    int tickMs = (int)args.number("--tick-ms", 500);
+    long long raceCount = args.number("--races", 1);
+    uint64_t seed = (uint64_t)args.number("--seed", 1);
+    int warmup = (int)args.number("--wait", 0); // subscribers to wait for before the lights go out
+
+    BroadcastServer server;
+    server.encoder() = BroadcastEncoder((int)args.number("--keyframe-every", 10));
+    bool listening;
+    string where;
+    if (const char *path = args.option("--socket"))
+    {
+        listening = server.listenUnix(path);
+        where = path;
+    }
+    else
+    {
+        listening = server.listenTcp((int)args.number("--port", 7425));
+        where = "127.0.0.1:" + to_string(args.number("--port", 7425));
+    }
+    if (!listening)
+    {
+        fprintf(stderr, "could not listen on %s\n", where.c_str());
+        return 1;
+    }
+    printf("Broadcasting on %s\n", where.c_str());
+
+    while ((int)server.subscriberCount() < warmup)
+    {
+        server.acceptPending();
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+
+    auto &trackList = trackCatalog();
+    auto &driverList = driverCatalog();
+    const Driver &player = *driverList[scenario.playerDriver];
+    RaceState race;
+    BroadcastSnapshot snapshot;
+    uint32_t tick = 0;
+
+    auto start = chrono::steady_clock::now();
+    for (long long n = 0; n < raceCount; ++n)
+    {
+        mt19937 gen(mixSeed(seed + n));
+        startRace(race, player, player.name, *trackList[scenario.track], scenario.totalLaps, gen);
+        race.policy = scenario.policy;
+        for (int lap = 1; lap <= race.totalLaps; ++lap)
+        {
+            simulateLap(race, strategyAction(scenario.strategy, lap), gen);
+            server.acceptPending();
+            snapshotRace(race, tick++, snapshot);
+            server.publish(snapshot);
+            if (tickMs > 0)
+                this_thread::sleep_for(chrono::milliseconds(tickMs));
+        }
+    }
+    double elapsed = secondsSince(start);
+
+    const BroadcastStats &stats = server.stats();
+    printf("%llu frames to %zu subscriber(s) in %.2fs: %.1f bytes/frame encoded, %.1f MB sent, %llu skipped, %llu dropped\n",
+           (unsigned long long)stats.frames, server.subscriberCount(), elapsed,
+           (double)stats.bytesEncoded / max<uint64_t>(stats.frames, 1), stats.bytesSent / 1e6,
+           (unsigned long long)stats.skipped, (unsigned long long)stats.dropped);
+    return 0;
+}
+
+static int cmdWatch(const Args &args)
+{
+    string address = args.option("--socket", args.option("--port", "7425"));
+    int connections = (int)max(1LL, args.number("--connections", 1));
+
+    // Extra connections only count frames; they exist to load the fan-out
+    vector<int> fds;
+    for (int i = 0; i < connections; ++i)
+    {
+        int fd = connectBroadcast(address);
+        if (fd < 0)
+        {
+            fprintf(stderr, "could not connect to %s\n", address.c_str());
+            return 1;
+        }
+        fds.push_back(fd);
+    }
+
+    size_t extraFrames = 0;
+    vector<thread> readers;
+    mutex merge;
+    for (int i = 1; i < connections; ++i)
+    {
+        readers.emplace_back([&, fd = fds[i]]()
+                             {
+            vector<uint8_t> buffer;
+            BroadcastDecoder decoder;
+            size_t frames = 0;
+            while (readBroadcastFrames(fd, buffer, decoder, frames))
+            {
+            }
+            lock_guard<mutex> lock(merge);
+            extraFrames += frames; });
+    }
+
+    auto &drivers = driverCatalog();
+    vector<uint8_t> buffer;
+    BroadcastDecoder decoder;
+    size_t frames = 0, shown = 0;
+    bool quiet = args.flag("--quiet");
+    while (readBroadcastFrames(fds[0], buffer, decoder, frames))
+    {
+        if (quiet || !decoder.ready() || frames == shown)
+            continue;
+        shown = frames;
+
+        const BroadcastSnapshot &state = decoder.state();
+        vector<const BroadcastCar *> standings;
+        for (auto &car : state.cars)
+            standings.push_back(&car);
+        sort(standings.begin(), standings.end(), [](const BroadcastCar *a, const BroadcastCar *b)
+             { return a->position < b->position; });
+
+        printf("\n--- tick %u ---\n", state.tick);
+        for (auto *car : standings)
+        {
+            printf("P%-2d %-18s +%7.3fs  last %s  tyre %3d%%  car %3d%%  stops %d%s\n", car->position,
+                   car->driver < drivers.size() ? drivers[car->driver]->name.c_str() : "?", car->gapMs / 1000.0,
+                   formatTime(car->lastLapMs / 1000.0).c_str(), car->tyre, car->vehicle, car->pitStops,
+                   (car->flags & kBroadcastInPit) ? "  PIT" : "");
+        }
+        fflush(stdout);
+    }
+
+    for (auto &reader : readers)
+        reader.join();
+    for (int fd : fds)
+        closeBroadcast(fd);
+    printf("%zu frames on %d connection(s)\n", frames + extraFrames, connections);
+    return 0;
+}
+
+static int cmdReport(const Args &args)
+{
+    RaceScenario scenario;
+    PolicyTable policy;
+    if (!scenarioFromArgs(args, scenario, policy))
+        return 2;
+
+    long long races = args.number("--races", 1000);
+    uint64_t seed = (uint64_t)args.number("--seed", 1);
+    int threads = (int)args.number("--threads", 0);
+    bool csv = strcmp(args.option("--format", "text"), "csv") == 0;
+
+    FILE *out = stdout;
+    const char *path = args.option("--out");
+    if (path && !(out = fopen(path, "wb")))
+    {
+        fprintf(stderr, "could not write %s\n", path);
+        return 1;
+    }
+
+    // Workers format their chunk into memory; chunks are written in order a
+    // window at a time, so memory stays flat however many races are asked for
+    const size_t chunk = 64;
+    const size_t window = chunk * 64;
+    ReportWriter writer(out, 4 << 20);
+    if (csv)
+        writeClassificationCsvHeader(writer);
+    vector<ReportWriter> chunks(window / chunk);
+    long long bytes = 0;
+    WorkerPerf perf(args.flag("--perf") ? resolveThreadCount(threads) : 0);
+    PerfCounters writerCounters;
+    PerfCounters *writerPerf = perf.empty() ? nullptr : &writerCounters; // the writing, on this thread
+    if (writerPerf)
+        writerPerf->open();
+
+    auto start = chrono::steady_clock::now();
+    for (long long base = 0; base < races; base += (long long)window)
+    {
+        size_t count = (size_t)min<long long>((long long)window, races - base);
+        parallelForWorkers((count + chunk - 1) / chunk, threads, [&](int worker, size_t begin, size_t end)
+                           {
+            RaceState race;
+            race.perf = workerPerf(perf, worker);
+            for (size_t c = begin; c < end; ++c)
+            {
+                chunks[c].clear();
+                for (size_t i = c * chunk; i < min(count, (c + 1) * chunk); ++i)
+                {
+                    uint64_t raceNo = (uint64_t)base + i;
+                    simulateRace(scenario, seed + raceNo, race);
+                    if (race.perf)
+                        race.perf->raceDone();
+                    perfBegin(race.perf, kPhaseText);
+                    if (csv)
+                        writeClassificationCsv(chunks[c], race, raceNo, seed + raceNo);
+                    else
+                        writeClassification(chunks[c], race);
+                    perfEnd(race.perf, kPhaseText);
+                }
+            } });
+
+        perfBegin(writerPerf, kPhaseRender);
+        for (size_t c = 0; c < (count + chunk - 1) / chunk; ++c)
+        {
+            writer.text(chunks[c].contents());
+            bytes += (long long)chunks[c].contents().size();
+        }
+        perfEnd(writerPerf, kPhaseRender);
+    }
+    perfBegin(writerPerf, kPhaseRender);
+    bool ok = writer.flush();
+    perfEnd(writerPerf, kPhaseRender);
+    double elapsed = secondsSince(start);
+    if (out != stdout && fclose(out) != 0)
+        ok = false;
+
+    fprintf(stderr, "%lld race reports, %.1f MB in %.2fs (%.0f races/s)\n", races, bytes / 1e6, elapsed,
+            races / max(elapsed, 1e-9));
+    if (!perf.empty())
+        reportPerf(stderr, perf, writerPerf);
+    if (!ok)
+    {
+        fprintf(stderr, "writing the report failed\n");
+        return 1;
+    }
+    return 0;
+}
+
+static int cmdScenarios(const Args &args)
+{
+    const char *path = args.positional();
+    if (!path)
+    {
+        fprintf(stderr, "usage: f1batch scenarios <file> [--threads N] [--piece N]\n");
+        return 2;
+    }
+
+    ScenarioStream stream;
+    if (!stream.open(path))
+    {
+        fprintf(stderr, "could not open scenario file %s\n", path);
+        return 1;
+    }
+
+    StreamRunOptions options;
+    options.threads = (int)args.number("--threads", options.threads);
+    options.pieceSize = (uint64_t)args.number("--piece", (long long)options.pieceSize);
+
+    long long races = 0;
+    bool bad = false;
+    auto start = chrono::steady_clock::now();
+    size_t count = runScenarioStream(
+        stream, options,
+        [&](const StreamedScenario &s, const BatchStats &stats)
+        {
+            races += stats.races;
+            printf("%zu\t%.*s\t%.*s\t%.*s\t%lld\t%.3f\t%.3f\t%.4f\n", s.line, (int)s.trackName.size(), s.trackName.data(),
+                   (int)s.driverName.size(), s.driverName.data(), (int)s.scenario.strategy.size(),
+                   s.scenario.strategy.data(), stats.races, stats.meanPosition(), stats.positionStdError(), stats.winRate());
+        },
+        [&](const string &errors)
+        {
+            fputs(errors.c_str(), stderr);
+            bad = true;
+        });
+    double elapsed = secondsSince(start);
+
+    fprintf(stderr, "%zu scenarios, %lld races in %.2fs (%.0f races/s)\n", count, races, elapsed,
+            races / max(elapsed, 1e-9));
+    return bad ? 1 : 0;
+}
+
+static int cmdSetupOpt(const Args &args)
+{
+    vector<string> allTracks;
+    for (auto &track : tracks)
+        allTracks.push_back(track.first);
+    vector<string> trackNames = listOption(args, "--tracks", "all", allTracks);
+
+    RaceScenario base;
+    base.playerDriver = findDriver(args.option("--driver", "Max Verstappen"));
+    base.totalLaps = (int)args.number("--laps", kDefaultRaceLaps);
+    base.strategy = args.option("--strategy", "");
+    if (base.playerDriver < 0 || base.totalLaps <= 0)
+    {
+        fprintf(stderr, "unknown --driver, or bad --laps\n");
+        return 2;
+    }
+
+    SetupSearchOptions options;
+    options.racesPerCandidate = (int)args.number("--races", options.racesPerCandidate);
+    options.gridSteps = (int)args.number("--grid", options.gridSteps);
+    options.refineRounds = (int)args.number("--refine", options.refineRounds);
+    options.threads = (int)args.number("--threads", options.threads);
+    options.seedBase = (uint64_t)args.number("--seed", (long long)options.seedBase);
+
+    for (auto &trackName : trackNames)
+    {
+        base.track = findTrack(trackName);
+        if (base.track < 0)
+        {
+            fprintf(stderr, "unknown track %s\n", trackName.c_str());
+            return 2;
+        }
+
+        auto start = chrono::steady_clock::now();
+        SetupSearchResult result = optimizeSetup(base, options);
+        double elapsed = secondsSince(start);
+        if (result.scenarioError)
+        {
+            fprintf(stderr, "%s: scenario could not be raced\n", trackName.c_str());
+            return 2;
+        }
+        printf("%-12s downforce %.3f  gearing %.3f  pressure %.3f  %s (%+.2fs vs baseline)  %d setups, %lld races, %.2fs\n",
+               trackName.c_str(), result.best.downforce, result.best.gearing, result.best.tyrePressure,
+               formatTime(result.bestTime).c_str(), result.bestTime - result.baselineTime, result.candidates,
+               result.races, elapsed);
+    }
+    return 0;
+}
+
+static int cmdEndurance(const Args &args)
+{
+    RaceScenario scenario;
+    PolicyTable policy;
+    if (!scenarioFromArgs(args, scenario, policy))
+        return 2;
+    int totalLaps = (int)args.number("--laps", 3000);
+    int reportEvery = max(1, (int)args.number("--report-every", 500));
+    if (totalLaps <= 0)
+    {
+        fprintf(stderr, "bad --laps\n");
+        return 2;
+    }
+
+    // The script repeats for the whole race, and the player boxes on worn
+    // tyres the way the AI does, so any strategy lasts thousands of laps
+    string_view strategy = scenario.strategy.empty() ? string_view("PSSSS") : scenario.strategy;
+    mt19937 gen(mixSeed((uint64_t)args.number("--seed", 1)));
+    const Driver &player = *driverCatalog()[scenario.playerDriver];
+
+    RaceState race;
+    race.keepHistory = true;
+    race.policy = scenario.policy;
+    startRace(race, player, player.name, *trackCatalog()[scenario.track], totalLaps, gen);
+
+    auto start = chrono::steady_clock::now();
+    auto blockStart = start;
+    for (int lap = 1; lap <= totalLaps; ++lap)
+    {
+        int action = -1;
+        if (isDecisionLap(lap))
+            action = strategyAction(strategy, (lap / 3) % (int)strategy.size() * 3 + 1);
+        if (race.field[race.playerIndex].tyre < 25.0)
+            action = 3;
+        simulateLap(race, action, gen);
+
+        if (lap % reportEvery == 0 || lap == totalLaps)
+        {
+            int laps = (lap - 1) % reportEvery + 1;
+            printf("lap %5d  P%-2d  %8.0f laps/s\n", lap, race.field[race.playerIndex].currentPos,
+                   laps / max(secondsSince(blockStart), 1e-9));
+            blockStart = chrono::steady_clock::now();
+        }
+    }
+    double elapsed = secondsSince(start);
+
+    const Racer &me = race.field[race.playerIndex];
+    printf("%d laps in %.2fs; %s finished P%d with %d stops, %s\n", totalLaps, elapsed, player.name.c_str(),
+           me.currentPos, me.pitStops, formatTime(me.cumulativeTime).c_str());
+
+    ReportWriter w(stdout);
+    writeStintSummary(w, race.history[race.playerIndex]);
+    w.flush();
+
+    for (int p = 0; p < 3 && p < (int)race.order.size(); ++p)
+    {
+        const Racer &r = race.field[race.order[p]];
+        printf("  P%d %-18s %s (%d stops)\n", p + 1, r.displayName, formatTime(r.cumulativeTime).c_str(), r.pitStops);
+    }
+    return 0;
+}
+
+static void printPairedStat(const char *label, const PairedStat &stat, const char *unit)
+{
+    printf("  %-16s A %9.3f%s  B %9.3f%s  B-A %+8.3f%s +/- %.3f%s  variance ratio %.1fx\n", label, stat.a.mean, unit,
+           stat.b.mean, unit, stat.diff.mean, unit, stat.halfWidth, unit, stat.varianceRatio);
+}
+
+static int cmdPaired(const Args &args)
+{
+    RaceScenario scenario;
+    PolicyTable policy;
+    if (!scenarioFromArgs(args, scenario, policy))
+        return 2;
+    vector<string> strategies = listOption(args, "--strategies", "PPPPPPPP,SSSSSSSS", {});
+    if (strategies.size() != 2)
+    {
+        fprintf(stderr, "--strategies takes exactly two plans, A,B\n");
+        return 2;
+    }
+
+    PairedOptions options;
+    options.races = args.number("--races", options.races);
+    options.commonDraws = !args.flag("--independent");
+    options.antithetic = args.flag("--antithetic");
+    options.threads = (int)args.number("--threads", options.threads);
+    options.seedBase = (uint64_t)args.number("--seed", (long long)options.seedBase);
+
+    auto start = chrono::steady_clock::now();
+    PairedReport report = compareStrategiesPaired(scenario, strategies[0], strategies[1], options);
+    double elapsed = secondsSince(start);
+    if (report.scenarioError)
+    {
+        fprintf(stderr, "scenario could not be raced\n");
+        return 2;
+    }
+
+    const char *mode = !options.commonDraws ? "independent draws"
+                       : options.antithetic ? "common draws, antithetic pairs"
+                                            : "common draws";
+    printf("A=%s vs B=%s, %lld races in %.2fs (%s)\n", strategies[0].c_str(), strategies[1].c_str(), report.races,
+           elapsed, mode);
+    printPairedStat("finish position", report.position, "");
+    printPairedStat("race time", report.raceTime, "s");
+    return 0;
+}
+
+static int cmdRatings(const Args &args)
+{
+    vector<string> allTracks;
+    for (auto &track : tracks)
+        allTracks.push_back(track.first);
+    vector<string> trackNames = listOption(args, "--tracks", "all", allTracks);
+
+    // Every driver takes a turn in the scripted player car, so the script
+    // weighs on all of them alike
+    RaceScenario base;
+    base.totalLaps = (int)args.number("--laps", kDefaultRaceLaps);
+    base.strategy = args.option("--strategy", "SSSBSSSS");
+    vector<RaceScenario> scenarios;
+    for (auto &name : trackNames)
+    {
+        base.track = findTrack(name);
+        if (base.track < 0 || base.totalLaps <= 0)
+        {
+            fprintf(stderr, "unknown track %s, or bad --laps\n", name.c_str());
+            return 2;
+        }
+        for (base.playerDriver = 0; base.playerDriver < fieldSize(); ++base.playerDriver)
+            scenarios.push_back(base);
+    }
+
+    long long maxRaces = args.number("--races", 1000000);
+    long long wave = max(1LL, args.number("--wave", 50000));
+    uint64_t seed = (uint64_t)args.number("--seed", 1);
+    int threads = (int)args.number("--threads", 0);
+
+    RatingOptions options;
+    options.stepRaces = args.number("--step", options.stepRaces);
+    RatingEngine engine(fieldSize(), options);
+    vector<RatingEngine::Accumulator> accumulators(resolveThreadCount(threads), engine.accumulator());
+
+    // Waves until the ratings stop moving or the budget runs out
+    RatingSnapshot ratings;
+    long long done = 0;
+    auto start = chrono::steady_clock::now();
+    while (done < maxRaces && !ratings.converged)
+    {
+        long long count = min(wave, maxRaces - done);
+        parallelForWorkers((size_t)count, threads, [&](int worker, size_t begin, size_t end)
+                           {
+            RatingEngine::Accumulator &acc = accumulators[worker];
+            vector<int> order(fieldSize());
+            RaceResult result;
+            for (size_t i = begin; i < end; ++i)
+            {
+                uint64_t raceNo = (uint64_t)done + i;
+                simulateRace(scenarios[raceNo % scenarios.size()], seed + raceNo, result, order.data());
+                acc.addRace(order.data(), (int)order.size());
+            }
+            if (acc.pending() >= 1024)
+                engine.merge(acc); });
+        for (auto &acc : accumulators)
+            engine.merge(acc);
+        done += count;
+        ratings = engine.snapshot();
+        fprintf(stderr, "%lld races, %d steps, last step %.2f Elo\n", ratings.races, ratings.steps, ratings.lastStep);
+    }
+    double elapsed = secondsSince(start);
+
+    printf("%lld races in %.2fs (%.0f races/s), %s\n", ratings.races, elapsed, ratings.races / max(elapsed, 1e-9),
+           ratings.converged ? "converged" : "not converged");
+    vector<DriverRating> table = ratings.drivers;
+    sort(table.begin(), table.end(), [](const DriverRating &a, const DriverRating &b) { return a.elo > b.elo; });
+    auto &drivers = driverCatalog();
+    printf("   #  %-18s %-12s %7s %6s %6s\n", "driver", "team", "elo", "+/-", "skill");
+    for (size_t k = 0; k < table.size(); ++k)
+    {
+        const Driver &d = *drivers[table[k].driverId];
+        printf("  %2zu  %-18s %-12s %7.1f %6.1f %6.2f\n", k + 1, d.name.c_str(), d.team.c_str(), table[k].elo,
+               confidenceZ(0.95) * table[k].stdError, driverSkillIndex(d));
+    }
+    return 0;
+}
+
+static int cmdQuery(const Args &args)
+{
+    const char *dir = args.option("--cache");
+    if (!dir)
+    {
+        fprintf(stderr, "usage: f1batch query --cache DIR [--seeds A-B] [--threads N], plus run's race options\n");
+        return 2;
+    }
+    RaceScenario scenario;
+    PolicyTable policy;
+    if (!scenarioFromArgs(args, scenario, policy))
+        return 2;
+    uint64_t seedBegin, seedEnd;
+    seedRange(args, seedBegin, seedEnd);
+
+    ResultCache cache;
+    if (!cache.open(dir))
+    {
+        fprintf(stderr, "could not open cache %s\n", dir);
+        return 1;
+    }
+    if (cache.staleRemoved() > 0)
+        printf("removed %d cache file(s) from another model\n", cache.staleRemoved());
+
+    CacheQueryInfo info;
+    auto start = chrono::steady_clock::now();
+    BatchStats stats = cache.query(scenario, seedBegin, seedEnd, (int)args.number("--threads", 0), &info);
+    double elapsed = secondsSince(start);
+
+    printf("%s: %lld races, mean finish P%.3f +/- %.3f, win %.1f%%, podium %.1f%%, %.2f stops\n",
+           driverCatalog()[scenario.playerDriver]->name.c_str(), stats.races, stats.meanPosition(),
+           confidenceZ(0.95) * stats.positionStdError(), 100.0 * stats.winRate(),
+           100.0 * stats.podiums / max(stats.races, 1LL), (double)stats.pitStops / max(stats.races, 1LL));
+    printf("%lld seeds from %d cached range(s), %lld simulated in %d gap(s), %.0f us\n", info.cachedRaces,
+           info.rangesUsed, info.simulatedRaces, info.rangesSimulated, elapsed * 1e6);
+    if (info.writeFailed)
+    {
+        fprintf(stderr, "writing to cache %s failed\n", dir);
+        return 1;
+    }
+    return 0;
+}
+
+static int cmdMultiplex(const Args &args)
+{
+    RaceScenario scenario;
+    PolicyTable policy;
+    if (!scenarioFromArgs(args, scenario, policy))
+        return 2;
+    int races = max(1, (int)args.number("--races", 10000));
+    int humans = clampVal((int)args.number("--humans", 0), 0, races);
+    int thinkMs = max(0, (int)args.number("--think-ms", 50));
+    int threads = resolveThreadCount((int)args.number("--threads", 0));
+    uint64_t seed = (uint64_t)args.number("--seed", 1);
+
+    // Races below --humans wait for input on every frame and decision; one
+    // thread stands in for their terminals, answering thinkMs later
+    struct Input
+    {
+        chrono::steady_clock::time_point due;
+        int id, action;
+    };
+    mutex inputLock;
+    condition_variable inputWake;
+    deque<Input> inputs;
+    bool closing = false;
+
+    FlowScheduler scheduler(threads, [&](int id, const RaceFlow &flow)
+                            {
+        if (flow.waiting() == FlowWait::Finished)
+            return -1;
+        int action = -1;
+        if (flow.waiting() == FlowWait::Decision)
+        {
+            // The script when there is one, else save tyres and box under 40%
+            const RaceState &race = flow.state();
+            const Racer &me = race.field[race.playerIndex];
+            if (!scenario.strategy.empty())
+                action = strategyAction(scenario.strategy, flow.lap());
+            else
+                action = me.tyre < 40.0 ? 3 : 2;
+        }
+        if (id >= humans)
+            return action;
+        lock_guard<mutex> guard(inputLock);
+        inputs.push_back({chrono::steady_clock::now() + chrono::milliseconds(thinkMs), id, action});
+        inputWake.notify_one();
+        return kFlowAwaitInput; });
+
+    thread terminals([&]()
+                     {
+        unique_lock<mutex> guard(inputLock);
+        while (true)
+        {
+            inputWake.wait(guard, [&] { return closing || !inputs.empty(); });
+            if (closing)
+                return;
+            Input next = inputs.front(); // think time is fixed, so due times are in order
+            if (inputWake.wait_until(guard, next.due, [&] { return closing; }))
+                return;
+            inputs.pop_front();
+            guard.unlock();
+            bool taken = scheduler.answer(next.id, next.action);
+            guard.lock();
+            // Too quick: the worker has not parked the race yet
+            if (!taken)
+                inputs.push_back(next);
+        } });
+
+    for (int i = 0; i < races; ++i)
+        scheduler.add(scenario, seed + i);
+    size_t bytes = scheduler.bytesPerRace(0);
+
+    auto start = chrono::steady_clock::now();
+    scheduler.start();
+    scheduler.wait();
+    double elapsed = secondsSince(start);
+    scheduler.stop();
+    {
+        lock_guard<mutex> guard(inputLock);
+        closing = true;
+    }
+    inputWake.notify_all();
+    terminals.join();
+
+    RunningStat position;
+    for (int i = 0; i < races; ++i)
+    {
+        const RaceState &race = scheduler.race(i);
+        position.add(race.field[race.playerIndex].currentPos);
+    }
+    FlowSchedulerStats stats = scheduler.stats();
+    printf("%d races (%d waiting on input) on %d thread(s) in %.2fs\n", races, humans, threads, elapsed);
+    printf("%lld resumes (%.0f/s), %lld parked for input, %zu bytes per suspended race (%.1f MB in all)\n",
+           stats.resumes, stats.resumes / max(elapsed, 1e-9), stats.parked, bytes, bytes * (double)races / 1e6);
+    printf("%s: mean finish P%.3f +/- %.3f\n", driverCatalog()[scenario.playerDriver]->name.c_str(), position.mean,
+           confidenceZ(0.95) * position.standardError());
+    return stats.finished == races ? 0 : 1;
+}
+
+static void usage()
+{
+    fprintf(stderr,
+            "usage: f1batch <command> [options]\n"
+            "  run                   simulate races (--track --driver --strategy --races --seed\n"
+            "                        --threads --laps --policy FILE --store DIR --dashboard --perf)\n"
+            "  sweep                 multi-process sweep (--workers --tracks --drivers --strategies\n"
+            "                        --seeds A-B --shard-size --laps --policy --kill-after N)\n"
+            "  store-query <dir>     history from a results store (--driver/--team, --track)\n"
+            "  policy-build <file>   precompute AI policy tables\n"
+            "  report                classification reports for many races (--format text|csv\n"
+            "                        --out FILE --races --seed --threads --perf, plus run's race options)\n"
+            "  scenarios <file>      stream a scenario file (--threads --piece N seeds per job);\n"
+            "                        lines are 'track; driver; strategy; seeds; grid; laps'\n"
+            "  setup-opt             best car setup per track (--tracks --driver --strategy --laps\n"
+            "                        --races N per setup --grid --refine --threads --seed)\n"
+            "  broadcast             serve live races (--socket PATH | --port N, --tick-ms\n"
+            "                        --keyframe-every --races --wait N, plus run's race options)\n"
+            "  watch                 follow a broadcast (--socket PATH | --port N,\n"
+            "                        --connections N --quiet)\n"
+            "  paired                compare two plans on the same random draws (--strategies A,B\n"
+            "                        --races --antithetic --independent --seed --threads)\n"
+            "  ratings               learned driver ratings (--tracks --races N max --wave N\n"
+            "                        --strategy for the player car --laps --seed --threads)\n"
+            "  endurance             one very long race with stint history (--laps, default 3000,\n"
+            "                        --report-every N --seed, plus run's race options)\n"
+            "  query                 cached statistics for a seed range (--cache DIR --seeds A-B\n"
+            "                        --threads, plus run's race options); only missing seeds run\n"
+            "  multiplex             many resumable races on a few threads (--races --threads\n"
+            "                        --humans N waiting on input --think-ms --seed, plus run's\n"
+            "                        race options)\n");
+}
+
+// ---------- Main Function ----------
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        usage();
+        return 2;
+    }
+
+    Args args{argc, argv};
+    string command = argv[1];
+    if (command == "run")
+        return cmdRun(args);
+    if (command == "sweep")
+        return cmdSweep(args);
+    if (command == "store-query")
+        return cmdStoreQuery(args);
+    if (command == "policy-build")
+        return cmdPolicyBuild(args);
+    if (command == "report")
+        return cmdReport(args);
+    if (command == "scenarios")
+        return cmdScenarios(args);
+    if (command == "setup-opt")
+        return cmdSetupOpt(args);
+    if (command == "broadcast")
+        return cmdBroadcast(args);
+    if (command == "watch")
+        return cmdWatch(args);
+    if (command == "paired")
+        return cmdPaired(args);
+    if (command == "ratings")
+        return cmdRatings(args);
+    if (command == "endurance")
+        return cmdEndurance(args);
+    if (command == "query")
+        return cmdQuery(args);
+    if (command == "multiplex")
+        return cmdMultiplex(args);
+
+    usage();
+    return 2;
+}
@@ -0,0 +1,504 @@
+// F1 TERMINAL RACER 2025 - LIVE BROADCAST
+
+#include "f1broadcast.h"
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+static const uint8_t kFrameKey = 'K';
+static const uint8_t kFrameDelta = 'D';
+static const size_t kFrameHeader = 14;
+
+enum CarField
+{
+    FieldPosition = 1 << 0,
+    FieldGap = 1 << 1,
+    FieldLastLap = 1 << 2,
+    FieldTyre = 1 << 3,
+    FieldVehicle = 1 << 4,
+    FieldPitStops = 1 << 5,
+    FieldFlags = 1 << 6
+};
+
+// ---------- Snapshots ----------
+
+void snapshotRace(const RaceState &race, uint32_t tick, BroadcastSnapshot &out)
+{
+    out.tick = tick;
+    out.cars.resize(race.field.size());
+
+    double leaderTime = race.order.empty() ? 0.0 : race.field[race.order[0]].cumulativeTime;
+    for (size_t i = 0; i < race.field.size(); ++i)
+    {
+        const Racer &r = race.field[i];
+        BroadcastCar &car = out.cars[i];
+        car.driver = (uint8_t)max(r.driverId, 0);
+        car.position = (uint8_t)r.currentPos;
+        car.tyre = (uint8_t)lround(r.tyre);
+        car.vehicle = (uint8_t)lround(r.vehicle);
+        car.pitStops = (uint8_t)min(r.pitStops, 255);
+        car.flags = r.inPitThisLap ? kBroadcastInPit : 0;
+        car.gapMs = (uint32_t)lround(max(0.0, r.cumulativeTime - leaderTime) * 1000.0);
+        car.lastLapMs = (uint32_t)lround(r.lastLapTime * 1000.0);
+    }
+}
+
+// ---------- Wire Format ----------
+
+static void putU32(vector<uint8_t> &b, uint32_t v)
+{
+    for (int i = 0; i < 4; ++i)
+        b.push_back((uint8_t)(v >> (8 * i)));
+}
+
+static uint32_t getU32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void putVarint(vector<uint8_t> &b, uint64_t v)
+{
+    while (v >= 0x80)
+    {
+        b.push_back((uint8_t)(v | 0x80));
+        v >>= 7;
+    }
+    b.push_back((uint8_t)v);
+}
+
+static bool getVarint(const uint8_t *&p, const uint8_t *end, uint64_t &v)
+{
+    v = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7)
+    {
+        uint8_t byte = *p++;
+        v |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+static void putDelta(vector<uint8_t> &b, int64_t now, int64_t key)
+{
+    int64_t d = now - key;
+    putVarint(b, ((uint64_t)d << 1) ^ (uint64_t)(d >> 63));
+}
+
+static bool getDelta(const uint8_t *&p, const uint8_t *end, int64_t key, int64_t &now)
+{
+    uint64_t z;
+    if (!getVarint(p, end, z))
+        return false;
+    now = key + (int64_t)((z >> 1) ^ (~(z & 1) + 1));
+    return true;
+}
+
+static void beginFrame(vector<uint8_t> &b, uint8_t type, uint32_t tick, uint32_t keyTick, size_t cars)
+{
+    b.clear();
+    putU32(b, 0); // length, patched in finishFrame
+    b.push_back(type);
+    putU32(b, tick);
+    putU32(b, keyTick);
+    b.push_back((uint8_t)cars);
+}
+
+static void finishFrame(vector<uint8_t> &b)
+{
+    uint32_t len = (uint32_t)(b.size() - 4);
+    for (int i = 0; i < 4; ++i)
+        b[i] = (uint8_t)(len >> (8 * i));
+}
+
+const vector<uint8_t> &BroadcastEncoder::encode(const BroadcastSnapshot &snapshot)
+{
+    wasKeyframe = keyframeFrame.empty() || sinceKeyframe >= interval || snapshot.cars.size() != keyframe.cars.size();
+
+    if (wasKeyframe)
+    {
+        beginFrame(frame, kFrameKey, snapshot.tick, snapshot.tick, snapshot.cars.size());
+        for (auto &car : snapshot.cars)
+        {
+            frame.push_back(car.driver);
+            frame.push_back(car.position);
+            putVarint(frame, car.gapMs);
+            putVarint(frame, car.lastLapMs);
+            frame.push_back(car.tyre);
+            frame.push_back(car.vehicle);
+            frame.push_back(car.pitStops);
+            frame.push_back(car.flags);
+        }
+        finishFrame(frame);
+        keyframe = snapshot;
+        keyframeFrame = frame;
+        sinceKeyframe = 1;
+        return frame;
+    }
+
+    beginFrame(frame, kFrameDelta, snapshot.tick, keyframe.tick, snapshot.cars.size());
+    for (size_t i = 0; i < snapshot.cars.size(); ++i)
+    {
+        const BroadcastCar &now = snapshot.cars[i];
+        const BroadcastCar &key = keyframe.cars[i];
+        uint8_t mask = (now.position != key.position ? FieldPosition : 0) | (now.gapMs != key.gapMs ? FieldGap : 0) |
+                       (now.lastLapMs != key.lastLapMs ? FieldLastLap : 0) | (now.tyre != key.tyre ? FieldTyre : 0) |
+                       (now.vehicle != key.vehicle ? FieldVehicle : 0) | (now.pitStops != key.pitStops ? FieldPitStops : 0) |
+                       (now.flags != key.flags ? FieldFlags : 0);
+        frame.push_back(mask);
+        if (mask & FieldPosition)
+            putDelta(frame, now.position, key.position);
+        if (mask & FieldGap)
+            putDelta(frame, now.gapMs, key.gapMs);
+        if (mask & FieldLastLap)
+            putDelta(frame, now.lastLapMs, key.lastLapMs);
+        if (mask & FieldTyre)
+            putDelta(frame, now.tyre, key.tyre);
+        if (mask & FieldVehicle)
+            putDelta(frame, now.vehicle, key.vehicle);
+        if (mask & FieldPitStops)
+            putDelta(frame, now.pitStops, key.pitStops);
+        if (mask & FieldFlags)
+            frame.push_back(now.flags);
+    }
+    finishFrame(frame);
+    sinceKeyframe++;
+    return frame;
+}
+
+bool BroadcastDecoder::apply(const uint8_t *data, size_t size)
+{
+    if (size < kFrameHeader || getU32(data) != size - 4)
+        return false;
+
+    uint8_t type = data[4];
+    uint32_t tick = getU32(data + 5);
+    uint32_t keyTick = getU32(data + 9);
+    size_t cars = data[13];
+    const uint8_t *p = data + kFrameHeader;
+    const uint8_t *end = data + size;
+
+    if (type == kFrameKey)
+    {
+        BroadcastSnapshot snap;
+        snap.tick = tick;
+        snap.cars.resize(cars);
+        for (auto &car : snap.cars)
+        {
+            uint64_t gap, lastLap;
+            if (end - p < 2)
+                return false;
+            car.driver = *p++;
+            car.position = *p++;
+            if (!getVarint(p, end, gap) || !getVarint(p, end, lastLap) || end - p < 4)
+                return false;
+            car.gapMs = (uint32_t)gap;
+            car.lastLapMs = (uint32_t)lastLap;
+            car.tyre = *p++;
+            car.vehicle = *p++;
+            car.pitStops = *p++;
+            car.flags = *p++;
+        }
+        keyframe = snap;
+        current = snap;
+        haveKeyframe = true;
+        return true;
+    }
+
+    // Deltas are only meaningful against the keyframe they were cut from
+    if (type != kFrameDelta || !haveKeyframe || keyTick != keyframe.tick || cars != keyframe.cars.size())
+        return false;
+
+    BroadcastSnapshot snap = keyframe;
+    snap.tick = tick;
+    for (size_t i = 0; i < cars; ++i)
+    {
+        if (p >= end)
+            return false;
+        uint8_t mask = *p++;
+        BroadcastCar &car = snap.cars[i];
+        int64_t v;
+        if (mask & FieldPosition)
+        {
+            if (!getDelta(p, end, car.position, v))
+                return false;
+            car.position = (uint8_t)v;
+        }
+        if (mask & FieldGap)
+        {
+            if (!getDelta(p, end, car.gapMs, v))
+                return false;
+            car.gapMs = (uint32_t)v;
+        }
+        if (mask & FieldLastLap)
+        {
+            if (!getDelta(p, end, car.lastLapMs, v))
+                return false;
+            car.lastLapMs = (uint32_t)v;
+        }
+        if (mask & FieldTyre)
+        {
+            if (!getDelta(p, end, car.tyre, v))
+                return false;
+            car.tyre = (uint8_t)v;
+        }
+        if (mask & FieldVehicle)
+        {
+            if (!getDelta(p, end, car.vehicle, v))
+                return false;
+            car.vehicle = (uint8_t)v;
+        }
+        if (mask & FieldPitStops)
+        {
+            if (!getDelta(p, end, car.pitStops, v))
+                return false;
+            car.pitStops = (uint8_t)v;
+        }
+        if (mask & FieldFlags)
+        {
+            if (p >= end)
+                return false;
+            car.flags = *p++;
+        }
+    }
+    current = move(snap);
+    return true;
+}
+
+#ifdef _WIN32
+
+BroadcastServer::~BroadcastServer() {}
+bool BroadcastServer::listenUnix(const string &) { return false; }
+bool BroadcastServer::listenTcp(int) { return false; }
+void BroadcastServer::close() {}
+void BroadcastServer::acceptPending() {}
+void BroadcastServer::publish(const BroadcastSnapshot &) {}
+bool BroadcastServer::sendFrame(Subscriber &, const vector<uint8_t> &) { return false; }
+int connectBroadcast(const string &) { return -1; }
+void closeBroadcast(int) {}
+bool readBroadcastFrames(int, vector<uint8_t> &, BroadcastDecoder &, size_t &) { return false; }
+
+#else
+
+// ---------- Server ----------
+
+static void setNonBlocking(int fd)
+{
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+}
+
+BroadcastServer::~BroadcastServer()
+{
+    close();
+}
+
+bool BroadcastServer::listenUnix(const string &path)
+{
+    close();
+    sockaddr_un addr = {};
+    if (path.size() >= sizeof(addr.sun_path))
+        return false;
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path.c_str());
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0)
+        return false;
+    unlink(path.c_str());
+    if (bind(listenFd, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(listenFd, SOMAXCONN) != 0)
+    {
+        close();
+        return false;
+    }
+    unixPath = path;
+    setNonBlocking(listenFd);
+    return true;
+}
+
+bool BroadcastServer::listenTcp(int port)
+{
+    close();
+    listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd < 0)
+        return false;
+    int on = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(listenFd, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(listenFd, SOMAXCONN) != 0)
+    {
+        close();
+        return false;
+    }
+    setNonBlocking(listenFd);
+    return true;
+}
+
+void BroadcastServer::close()
+{
+    for (auto &sub : subscribers)
+        ::close(sub.fd);
+    subscribers.clear();
+    if (listenFd >= 0)
+        ::close(listenFd);
+    listenFd = -1;
+    if (!unixPath.empty())
+        unlink(unixPath.c_str());
+    unixPath.clear();
+}
+
+void BroadcastServer::acceptPending()
+{
+    if (listenFd < 0)
+        return;
+    while (true)
+    {
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0)
+            break;
+        setNonBlocking(fd);
+        int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on)); // harmless failure on Unix sockets
+        subscribers.push_back({fd, true});
+    }
+}
+
+bool BroadcastServer::sendFrame(Subscriber &sub, const vector<uint8_t> &bytes)
+{
+    ssize_t n;
+    do
+        n = send(sub.fd, bytes.data(), bytes.size(), MSG_NOSIGNAL);
+    while (n < 0 && errno == EINTR);
+
+    if (n == (ssize_t)bytes.size())
+    {
+        counters.bytesSent += (uint64_t)n;
+        return true;
+    }
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    {
+        // Nothing went out: skip this frame and resync on a keyframe
+        sub.needKeyframe = true;
+        counters.skipped++;
+        return true;
+    }
+
+    // Peer gone, or a partial frame that would desync the stream
+    ::close(sub.fd);
+    sub.fd = -1;
+    counters.dropped++;
+    return false;
+}
+
+void BroadcastServer::publish(const BroadcastSnapshot &snapshot)
+{
+    const vector<uint8_t> &frame = enc.encode(snapshot);
+    bool keyframe = enc.lastWasKeyframe();
+    counters.frames++;
+    counters.bytesEncoded += frame.size();
+
+    for (auto &sub : subscribers)
+    {
+        if (sub.needKeyframe && !keyframe)
+        {
+            sub.needKeyframe = false;
+            if (!sendFrame(sub, enc.keyframeBytes()) || sub.needKeyframe)
+                continue;
+        }
+        sub.needKeyframe = false;
+        sendFrame(sub, frame);
+    }
+
+    subscribers.erase(remove_if(subscribers.begin(), subscribers.end(), [](const Subscriber &s) { return s.fd < 0; }),
+                      subscribers.end());
+}
+
+// ---------- Subscriber ----------
+
+int connectBroadcast(const string &address)
+{
+    int fd;
+    if (address.find('/') != string::npos)
+    {
+        sockaddr_un addr = {};
+        if (address.size() >= sizeof(addr.sun_path))
+            return -1;
+        addr.sun_family = AF_UNIX;
+        strcpy(addr.sun_path, address.c_str());
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && connect(fd, (sockaddr *)&addr, sizeof(addr)) != 0)
+        {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    // "port" or "host:port"
+    size_t colon = address.rfind(':');
+    string host = colon == string::npos ? "127.0.0.1" : address.substr(0, colon);
+    int port = atoi(address.c_str() + (colon == string::npos ? 0 : colon + 1));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1)
+        return -1;
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd >= 0 && connect(fd, (sockaddr *)&addr, sizeof(addr)) != 0)
+    {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+void closeBroadcast(int fd)
+{
+    if (fd >= 0)
+        ::close(fd);
+}
+
+bool readBroadcastFrames(int fd, vector<uint8_t> &buffer, BroadcastDecoder &decoder, size_t &framesOut)
+{
+    uint8_t chunk[16384];
+    ssize_t n;
+    do
+        n = recv(fd, chunk, sizeof(chunk), 0);
+    while (n < 0 && errno == EINTR);
+    if (n <= 0)
+        return false;
+    buffer.insert(buffer.end(), chunk, chunk + n);
+
+    size_t used = 0;
+    while (buffer.size() - used >= 4)
+    {
+        size_t len = getU32(buffer.data() + used) + 4;
+        if (buffer.size() - used < len)
+            break;
+        decoder.apply(buffer.data() + used, len);
+        framesOut++;
+        used += len;
+    }
+    buffer.erase(buffer.begin(), buffer.begin() + used);
+    return true;
+}
+
+#endif
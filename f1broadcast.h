@@ -0,0 +1,121 @@
+// F1 TERMINAL RACER 2025 - LIVE BROADCAST
+// Keyframe + delta encoded race state fanned out to socket subscribers.
+
+#ifndef F1BROADCAST_H
+#define F1BROADCAST_H
+
+#include "f1sim.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ---------- Snapshots ----------
+
+const std::uint8_t kBroadcastInPit = 1;
+
+struct BroadcastCar
+{
+    std::uint8_t driver = 0, position = 0, tyre = 0, vehicle = 0, pitStops = 0, flags = 0;
+    std::uint32_t gapMs = 0, lastLapMs = 0; // gap to the leader
+};
+
+struct BroadcastSnapshot
+{
+    std::uint32_t tick = 0;
+    std::vector<BroadcastCar> cars; // field order, stable for a race
+};
+
+void snapshotRace(const RaceState &race, std::uint32_t tick, BroadcastSnapshot &out);
+
+// ---------- Wire Format ----------
+
+// Frame: u32 length, u8 type, u32 tick, u32 keyframe tick, u8 car count.
+// Keyframes carry every field. Deltas carry, per car, a change mask and
+// zigzag varints against the last keyframe (not the previous tick), so a
+// subscriber that missed deltas only needs the next one to catch up.
+class BroadcastEncoder
+{
+public:
+    explicit BroadcastEncoder(int keyframeInterval = 10) : interval(keyframeInterval) {}
+
+    // Encodes into the shared frame buffer; valid until the next call.
+    const std::vector<std::uint8_t> &encode(const BroadcastSnapshot &snapshot);
+    bool lastWasKeyframe() const { return wasKeyframe; }
+    const std::vector<std::uint8_t> &keyframeBytes() const { return keyframeFrame; }
+
+private:
+    int interval;
+    int sinceKeyframe = 0;
+    bool wasKeyframe = false;
+    BroadcastSnapshot keyframe;
+    std::vector<std::uint8_t> frame, keyframeFrame;
+};
+
+class BroadcastDecoder
+{
+public:
+    // data holds one whole frame including its length prefix.
+    bool apply(const std::uint8_t *data, std::size_t size);
+    bool ready() const { return haveKeyframe; }
+    const BroadcastSnapshot &state() const { return current; }
+
+private:
+    bool haveKeyframe = false;
+    BroadcastSnapshot keyframe, current;
+};
+
+// ---------- Server ----------
+
+struct BroadcastStats
+{
+    std::uint64_t frames = 0, bytesEncoded = 0, bytesSent = 0, skipped = 0, dropped = 0;
+};
+
+// Single-threaded, non-blocking fan-out: one encode per tick, then one send
+// of the shared buffer per subscriber. A subscriber whose socket is full
+// skips frames until it can take a keyframe again; a partial write drops
+// it. POSIX only.
+class BroadcastServer
+{
+public:
+    ~BroadcastServer();
+
+    bool listenUnix(const std::string &path);
+    bool listenTcp(int port);
+    void close();
+
+    void acceptPending();
+    void publish(const BroadcastSnapshot &snapshot);
+
+    std::size_t subscriberCount() const { return subscribers.size(); }
+    const BroadcastStats &stats() const { return counters; }
+    BroadcastEncoder &encoder() { return enc; }
+
+private:
+    struct Subscriber
+    {
+        int fd;
+        bool needKeyframe;
+    };
+
+    bool sendFrame(Subscriber &sub, const std::vector<std::uint8_t> &bytes);
+
+    int listenFd = -1;
+    std::string unixPath;
+    std::vector<Subscriber> subscribers;
+    BroadcastEncoder enc;
+    BroadcastStats counters;
+};
+
+// Connects a subscriber socket; returns -1 on failure.
+// address is a Unix socket path (contains '/'), "port" or "host:port".
+int connectBroadcast(const std::string &address);
+void closeBroadcast(int fd);
+
+// Reads whole frames from fd into buffer; calls the decoder for each.
+// Returns false when the connection closes.
+bool readBroadcastFrames(int fd, std::vector<std::uint8_t> &buffer, BroadcastDecoder &decoder, std::size_t &framesOut);
+
+#endif
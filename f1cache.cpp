@@ -0,0 +1,484 @@
+// F1 TERMINAL RACER 2025 - SIMULATION CACHE
+
+#include "f1cache.h"
+#include "f1policy.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+static const char kCacheMagic[4] = {'F', '1', 'R', 'C'};
+static const uint32_t kCacheVersion = 1;
+static const char *const kCacheExtension = ".f1c";
+
+// ---------- Keys ----------
+
+struct KeyHash
+{
+    uint64_t value = 0xCBF29CE484222325ull;
+
+    void add(uint64_t v)
+    {
+        value = (value ^ v) * 0x9E3779B97F4A7C15ull;
+        value ^= value >> 32;
+    }
+
+    void real(double d)
+    {
+        uint64_t bits;
+        memcpy(&bits, &d, sizeof(bits));
+        add(bits);
+    }
+
+    void text(const string &s)
+    {
+        for (unsigned char ch : s)
+            add(ch);
+        add(0xFFu);
+    }
+
+    // Eight bytes a step, so a full policy table hashes in microseconds
+    void bytes(const uint8_t *data, size_t size)
+    {
+        add(size);
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8)
+        {
+            uint64_t word;
+            memcpy(&word, data + i, sizeof(word));
+            add(word);
+        }
+        for (; i < size; ++i)
+            add(data[i]);
+    }
+};
+
+static void hashResult(KeyHash &h, const RaceResult &result, const vector<int> &order)
+{
+    h.add((uint64_t)result.playerPosition);
+    h.add((uint64_t)result.playerPitStops);
+    h.add((uint64_t)result.winnerDriver);
+    h.add((uint64_t)result.fastestLapDriver);
+    h.real(result.playerTime);
+    h.real(result.fastestLap);
+    for (int id : order)
+        h.add((uint64_t)id);
+}
+
+uint64_t modelFingerprint()
+{
+    static const uint64_t fingerprint = []
+    {
+        KeyHash h;
+        h.add(kCacheVersion);
+
+        auto &trackList = trackCatalog();
+        auto &driverList = driverCatalog();
+        for (auto *track : trackList)
+        {
+            h.text(track->name);
+            h.real(track->baseLapSec);
+            h.add((uint64_t)track->difficulty);
+            h.add((uint64_t)track->corners);
+            h.real(track->pitStopTime);
+        }
+        for (auto *driver : driverList)
+        {
+            h.text(driver->name);
+            h.text(driver->team);
+            for (int stat : {driver->speed, driver->cornering, driver->overtaking, driver->consistency,
+                             driver->aggression, driver->strategy})
+                h.add((uint64_t)stat);
+        }
+        for (auto &team : teams)
+        {
+            h.text(team.first);
+            h.real(team.second.performance);
+        }
+
+        // The coefficients live in code, so run them: a short race per track
+        // on the generator path, one on common antithetic draws with a
+        // custom setup and one under a patterned policy table
+        PolicyTable policy;
+        policy.trackCount = (int)trackList.size();
+        policy.driverCount = (int)driverList.size();
+        policy.actions.resize((size_t)policy.trackCount * policy.driverCount * kPolicyLapBuckets *
+                              kPolicyTyreBuckets * kPolicyVehicleBuckets * kPolicyGapBuckets);
+        for (size_t i = 0; i < policy.actions.size(); ++i)
+            policy.actions[i] = (uint8_t)((i * 7 + i / 13) % 4);
+
+        const CarSetup setup = {0.2, 0.8, 0.35};
+        vector<int> order(fieldSize());
+        RaceResult result;
+        for (int t = 0; t < (int)trackList.size(); ++t)
+        {
+            for (int probe = 0; probe < 3; ++probe)
+            {
+                RaceScenario scenario;
+                scenario.track = t;
+                scenario.playerDriver = (t * 7 + probe) % (int)driverList.size();
+                scenario.totalLaps = 13;
+                scenario.strategy = probe == 1 ? "SBPP" : "PBSP";
+                scenario.commonDraws = scenario.antithetic = (probe == 1);
+                scenario.setup = probe == 1 ? &setup : nullptr;
+                scenario.policy = probe == 2 ? &policy : nullptr;
+                if (simulateRace(scenario, 0xF1CAC4Eull + t * 3 + probe, result, order.data()))
+                    hashResult(h, result, order);
+            }
+        }
+        return h.value;
+    }();
+    return fingerprint;
+}
+
+uint64_t scenarioKey(const RaceScenario &scenario)
+{
+    KeyHash h;
+    h.add(modelFingerprint());
+    h.add((uint64_t)scenario.track);
+    h.add((uint64_t)scenario.playerDriver);
+    h.add((uint64_t)scenario.totalLaps);
+
+    // "pssb", "PSSB" and "PSSB--" run the same race when it has four decision laps
+    for (int lap = 1; lap <= scenario.totalLaps; ++lap)
+    {
+        if (isDecisionLap(lap))
+            h.add((uint64_t)(strategyAction(scenario.strategy, lap) + 1));
+    }
+
+    auto &trackList = trackCatalog();
+    CarSetup setup;
+    if (scenario.setup)
+        setup = *scenario.setup;
+    else if (scenario.track >= 0 && scenario.track < (int)trackList.size())
+        setup = baselineSetup(*trackList[scenario.track]);
+    h.real(setup.downforce);
+    h.real(setup.gearing);
+    h.real(setup.tyrePressure);
+
+    h.add((uint64_t)max(scenario.gridSize, 0));
+    for (int k = 0; k < scenario.gridSize; ++k)
+        h.add((uint64_t)scenario.grid[k]);
+
+    h.add(scenario.commonDraws);
+    h.add(scenario.commonDraws && scenario.antithetic); // mirroring only touches common draws
+
+    h.add(scenario.policy != nullptr);
+    if (scenario.policy)
+    {
+        h.add((uint64_t)scenario.policy->trackCount);
+        h.add((uint64_t)scenario.policy->driverCount);
+        h.bytes(scenario.policy->actions.data(), scenario.policy->actions.size());
+    }
+    return h.value;
+}
+
+// ---------- Storage ----------
+
+struct CacheFileHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t fingerprint, key;
+    uint32_t count, reserved;
+};
+
+static bool readHeader(FILE *f, CacheFileHeader &header)
+{
+    return fread(&header, sizeof(header), 1, f) == 1 && equal(kCacheMagic, kCacheMagic + 4, header.magic) &&
+           header.version == kCacheVersion;
+}
+
+bool ResultCache::open(const string &directory)
+{
+    dir.clear();
+    memory.clear();
+    removed = 0;
+
+    error_code ec;
+    fs::create_directories(directory, ec);
+    if (!fs::is_directory(directory, ec))
+        return false;
+    fingerprint = modelFingerprint();
+
+    // Keys already include the model, so files from another one are dead weight
+    for (auto &entry : fs::directory_iterator(directory, ec))
+    {
+        if (entry.path().extension() != kCacheExtension)
+            continue;
+        FILE *f = fopen(entry.path().string().c_str(), "rb");
+        if (!f)
+            continue;
+        CacheFileHeader header;
+        bool stale = !readHeader(f, header) || header.fingerprint != fingerprint;
+        fclose(f);
+        error_code removeError;
+        if (stale && fs::remove(entry.path(), removeError))
+            removed++;
+    }
+
+    dir = directory;
+    return true;
+}
+
+string ResultCache::pathFor(uint64_t key) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx%s", (unsigned long long)key, kCacheExtension);
+    return (fs::path(dir) / name).string();
+}
+
+bool ResultCache::load(uint64_t key, vector<CachedRange> &ranges) const
+{
+    FILE *f = fopen(pathFor(key).c_str(), "rb");
+    if (!f)
+        return false;
+
+    CacheFileHeader header;
+    bool ok = readHeader(f, header) && header.fingerprint == fingerprint && header.key == key &&
+              header.count <= 4 * kCacheMaxRanges;
+    vector<CachedRange> stored;
+    if (ok)
+    {
+        stored.resize(header.count);
+        ok = fread(stored.data(), sizeof(CachedRange), stored.size(), f) == stored.size();
+    }
+    fclose(f);
+    if (ok)
+        ranges.swap(stored);
+    return ok;
+}
+
+static bool sameRange(const CachedRange &a, const CachedRange &b)
+{
+    return a.seedBegin == b.seedBegin && a.seedEnd == b.seedEnd;
+}
+
+static bool contains(const CachedRange &outer, const CachedRange &inner)
+{
+    return outer.seedBegin <= inner.seedBegin && inner.seedEnd <= outer.seedEnd && !sameRange(outer, inner);
+}
+
+// Drops ranges another one already spans first, then the shortest
+static void pruneRanges(vector<CachedRange> &ranges)
+{
+    while ((int)ranges.size() > kCacheMaxRanges)
+    {
+        int victim = -1;
+        bool victimContained = false;
+        for (int i = 0; i < (int)ranges.size(); ++i)
+        {
+            bool contained = any_of(ranges.begin(), ranges.end(),
+                                    [&](const CachedRange &other) { return contains(other, ranges[i]); });
+            uint64_t length = ranges[i].seedEnd - ranges[i].seedBegin;
+            if (victim < 0 || (contained && !victimContained) ||
+                (contained == victimContained && length < ranges[victim].seedEnd - ranges[victim].seedBegin))
+            {
+                victim = i;
+                victimContained = contained;
+            }
+        }
+        ranges.erase(ranges.begin() + victim);
+    }
+}
+
+bool ResultCache::save(uint64_t key, vector<CachedRange> &ranges) const
+{
+    // Keep whatever other processes stored since we last looked
+    vector<CachedRange> disk;
+    if (load(key, disk))
+    {
+        for (auto &range : disk)
+        {
+            if (none_of(ranges.begin(), ranges.end(), [&](const CachedRange &r) { return sameRange(r, range); }))
+                ranges.push_back(range);
+        }
+    }
+    pruneRanges(ranges);
+
+    string path = pathFor(key);
+    string temp = path + "." + to_string(chrono::steady_clock::now().time_since_epoch().count()) + ".tmp";
+    FILE *f = fopen(temp.c_str(), "wb");
+    if (!f)
+        return false;
+
+    CacheFileHeader header = {};
+    copy(kCacheMagic, kCacheMagic + 4, header.magic);
+    header.version = kCacheVersion;
+    header.fingerprint = fingerprint;
+    header.key = key;
+    header.count = (uint32_t)ranges.size();
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+              fwrite(ranges.data(), sizeof(CachedRange), ranges.size(), f) == ranges.size();
+    ok = fclose(f) == 0 && ok;
+
+    // Readers see the old file or the new one, never half of either
+    error_code ec;
+    if (ok)
+        fs::rename(temp, path, ec);
+    if (!ok || ec)
+    {
+        fs::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
+
+// ---------- Query ----------
+
+// Non-overlapping stored ranges inside [begin, end) covering the most
+// seeds, fewest pieces on a tie, in seed order: weighted interval
+// scheduling over ranges by end
+static vector<const CachedRange *> bestCover(const vector<CachedRange> &ranges, uint64_t begin, uint64_t end)
+{
+    vector<const CachedRange *> inside;
+    for (auto &range : ranges)
+    {
+        if (range.seedBegin >= begin && range.seedEnd <= end && range.seedBegin < range.seedEnd)
+            inside.push_back(&range);
+    }
+    sort(inside.begin(), inside.end(),
+         [](const CachedRange *a, const CachedRange *b) { return a->seedEnd < b->seedEnd; });
+
+    // (seeds covered, -pieces) compares the way we want
+    typedef pair<uint64_t, long long> Score;
+    size_t n = inside.size();
+    vector<Score> best(n + 1, Score(0, 0));
+    vector<size_t> before(n, 0); // ranges ending at or before this one starts
+    for (size_t i = 0; i < n; ++i)
+    {
+        size_t j = i;
+        while (j > 0 && inside[j - 1]->seedEnd > inside[i]->seedBegin)
+            --j;
+        before[i] = j;
+        Score take(best[j].first + (inside[i]->seedEnd - inside[i]->seedBegin), best[j].second - 1);
+        best[i + 1] = max(best[i], take);
+    }
+
+    vector<const CachedRange *> cover;
+    for (size_t i = n; i > 0;)
+    {
+        if (best[i] == best[i - 1])
+        {
+            --i;
+            continue;
+        }
+        cover.push_back(inside[i - 1]);
+        i = before[i - 1];
+    }
+    reverse(cover.begin(), cover.end());
+    return cover;
+}
+
+BatchStats ResultCache::query(const RaceScenario &scenario, uint64_t seedBegin, uint64_t seedEnd, int threads,
+                              CacheQueryInfo *info)
+{
+    CacheQueryInfo local;
+    CacheQueryInfo &out = info ? *info : local;
+    out = CacheQueryInfo();
+    BatchStats total;
+    if (seedEnd <= seedBegin)
+        return total;
+    if (!isOpen())
+    {
+        total = simulateSeedRange(scenario, seedBegin, seedEnd);
+        out.simulatedRaces = (long long)(seedEnd - seedBegin);
+        return total;
+    }
+
+    uint64_t key = scenarioKey(scenario);
+    lock_guard<mutex> guard(lock);
+    auto found = memory.find(key);
+    if (found == memory.end())
+    {
+        found = memory.emplace(key, vector<CachedRange>()).first;
+        load(key, found->second);
+    }
+    vector<CachedRange> &ranges = found->second;
+
+    auto covered = [&](const vector<const CachedRange *> &cover)
+    {
+        uint64_t seeds = 0;
+        for (auto *range : cover)
+            seeds += range->seedEnd - range->seedBegin;
+        return seeds;
+    };
+    vector<const CachedRange *> cover = bestCover(ranges, seedBegin, seedEnd);
+    if (covered(cover) < seedEnd - seedBegin)
+    {
+        // Another process may have filled the gap since we read the file
+        vector<CachedRange> disk;
+        if (load(key, disk))
+        {
+            for (auto &range : disk)
+            {
+                if (none_of(ranges.begin(), ranges.end(), [&](const CachedRange &r) { return sameRange(r, range); }))
+                    ranges.push_back(range);
+            }
+            cover = bestCover(ranges, seedBegin, seedEnd);
+        }
+    }
+
+    // Gaps between the cached pieces, in seed order
+
+    vector<CachedRange> gaps;
+    uint64_t at = seedBegin;
+    for (auto *range : cover)
+    {
+        if (range->seedBegin > at)
+            gaps.push_back({at, range->seedBegin, BatchStats()});
+        at = range->seedEnd;
+        total.merge(range->stats);
+        out.cachedRaces += (long long)(range->seedEnd - range->seedBegin);
+    }
+    if (at < seedEnd)
+        gaps.push_back({at, seedEnd, BatchStats()});
+    out.rangesUsed = (int)cover.size();
+    out.rangesSimulated = (int)gaps.size();
+    if (gaps.empty())
+        return total;
+
+    // Every gap seed in one parallel pass; integer sums merge in any order
+
+    vector<uint64_t> gapStart(gaps.size() + 1, 0);
+    for (size_t g = 0; g < gaps.size(); ++g)
+        gapStart[g + 1] = gapStart[g] + (gaps[g].seedEnd - gaps[g].seedBegin);
+    mutex merge;
+    parallelFor((size_t)gapStart.back(), threads, [&](size_t begin, size_t end)
+                {
+        vector<BatchStats> partial(gaps.size());
+        size_t g = upper_bound(gapStart.begin(), gapStart.end(), begin) - gapStart.begin() - 1;
+        RaceResult result;
+        for (size_t i = begin; i < end; ++i)
+        {
+            while (i >= gapStart[g + 1])
+                ++g;
+            if (simulateRace(scenario, gaps[g].seedBegin + (i - gapStart[g]), result))
+                partial[g].add(result);
+        }
+        lock_guard<mutex> mergeGuard(merge);
+        for (size_t k = 0; k < gaps.size(); ++k)
+            gaps[k].stats.merge(partial[k]); });
+
+    for (auto &gap : gaps)
+    {
+        total.merge(gap.stats);
+        out.simulatedRaces += (long long)(gap.seedEnd - gap.seedBegin);
+    }
+
+    // Store the new pieces and, when the answer was stitched, the whole range
+    // (cover points into ranges, so it is not used past this point)
+    CachedRange whole = {seedBegin, seedEnd, total};
+    bool stitched = cover.size() + gaps.size() > 1;
+    for (auto &gap : gaps)
+        ranges.push_back(gap);
+    if (stitched && none_of(ranges.begin(), ranges.end(), [&](const CachedRange &r) { return sameRange(r, whole); }))
+        ranges.push_back(whole);
+    out.writeFailed = !save(key, ranges);
+    return total;
+}
@@ -0,0 +1,77 @@
+// F1 TERMINAL RACER 2025 - SIMULATION CACHE
+// On-disk batch statistics keyed by scenario and model, reused across runs.
+
+#ifndef F1CACHE_H
+#define F1CACHE_H
+
+#include "f1batch.h"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ---------- Keys ----------
+
+// Hash of the catalogs and of probe races run through every part of the
+// race model, computed once per process. Any change to a coefficient, a
+// driver, a track or the AI moves it, so results from an older model are
+// never served.
+std::uint64_t modelFingerprint();
+
+// Canonical hash of what a scenario actually simulates, model included:
+// the strategy as the actions it takes on this race's decision laps, a
+// null setup as the baseline it stands for, the policy table by content.
+std::uint64_t scenarioKey(const RaceScenario &scenario);
+
+// ---------- Results Cache ----------
+
+const int kCacheMaxRanges = 64; // per scenario, redundant and small ranges go first
+
+struct CachedRange
+{
+    std::uint64_t seedBegin = 0, seedEnd = 0;
+    BatchStats stats;
+};
+
+struct CacheQueryInfo
+{
+    long long cachedRaces = 0, simulatedRaces = 0;
+    int rangesUsed = 0, rangesSimulated = 0;
+    bool writeFailed = false;
+};
+
+// One small file per scenario key holding BatchStats for seed ranges.
+// A query takes the stored ranges that best cover it without overlapping,
+// simulates only the gaps and stores them together with the whole range,
+// so asking again is a single lookup. BatchStats are integer sums, so the
+// merged answer is bit-identical to simulating the range in one go.
+// Files are replaced by rename and re-read before each write, so several
+// processes can share a directory; open() deletes files from other models.
+class ResultCache
+{
+public:
+    bool open(const std::string &directory);
+    bool isOpen() const { return !dir.empty(); }
+
+    // Stats for seeds [seedBegin, seedEnd). Gaps run on threads workers,
+    // every core when <= 0.
+    BatchStats query(const RaceScenario &scenario, std::uint64_t seedBegin, std::uint64_t seedEnd, int threads = 0,
+                     CacheQueryInfo *info = nullptr);
+
+    int staleRemoved() const { return removed; }
+
+private:
+    std::string pathFor(std::uint64_t key) const;
+    bool load(std::uint64_t key, std::vector<CachedRange> &ranges) const;
+    bool save(std::uint64_t key, std::vector<CachedRange> &ranges) const;
+
+    std::string dir;
+    std::uint64_t fingerprint = 0;
+    int removed = 0;
+    std::mutex lock;
+    std::unordered_map<std::uint64_t, std::vector<CachedRange>> memory;
+};
+
+#endif
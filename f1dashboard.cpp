@@ -0,0 +1,179 @@
+// F1 TERMINAL RACER 2025 - LIVE DASHBOARD
+
+#include "f1dashboard.h"
+#include "f1sim.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+using namespace std;
+
+void ProgressRecord::fold(const ProgressRecord &other)
+{
+    races += other.races;
+    busyNanos += other.busyNanos;
+    for (int d = 0; d < kProgressDrivers; ++d)
+        wins[d] += other.wins[d];
+}
+
+// ---------- Dashboard ----------
+
+ProgressDashboard::ProgressDashboard(int workers, long long totalRaces, int playerDriver, int refreshMs)
+    : totalRaces(totalRaces), playerDriver(playerDriver), refreshMs(max(refreshMs, 20))
+{
+    for (int w = 0; w < max(workers, 1); ++w)
+        slots.push_back(make_unique<Slot>());
+    totals.resize(slots.size());
+    wins.assign(kProgressDrivers, 0);
+}
+
+ProgressDashboard::~ProgressDashboard()
+{
+    stop();
+}
+
+void ProgressDashboard::start()
+{
+    if (display.joinable())
+        return;
+    startTime = windowStart = chrono::steady_clock::now();
+    stopping = false;
+    display = thread(&ProgressDashboard::displayLoop, this);
+}
+
+void ProgressDashboard::stop()
+{
+    if (!display.joinable())
+        return;
+    {
+        lock_guard<mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    display.join();
+}
+
+void ProgressDashboard::publish(int worker, const ProgressRecord &record)
+{
+    Slot &slot = *slots[worker % slots.size()];
+    if (!slot.hasPending)
+    {
+        if (slot.ring.tryPush(record))
+            return;
+        slot.pending = record;
+        slot.hasPending = true;
+        return;
+    }
+
+    slot.pending.fold(record);
+    if (slot.ring.tryPush(slot.pending))
+        slot.hasPending = false;
+}
+
+void ProgressDashboard::displayLoop()
+{
+    unique_lock<mutex> lock(wakeMutex);
+    while (!stopping)
+    {
+        wake.wait_for(lock, chrono::milliseconds(refreshMs), [this] { return stopping; });
+        drain(stopping);
+        draw(stopping);
+    }
+}
+
+void ProgressDashboard::drain(bool final)
+{
+    ProgressRecord record;
+    for (size_t w = 0; w < slots.size(); ++w)
+    {
+        // Workers have finished by the final drain, so their held-back
+        // records are safe to read
+        bool popped;
+        while ((popped = slots[w]->ring.tryPop(record)) || (final && slots[w]->hasPending))
+        {
+            if (!popped)
+            {
+                record = slots[w]->pending;
+                slots[w]->hasPending = false;
+            }
+            totals[w].races += record.races;
+            totals[w].busyNanos += record.busyNanos;
+            totals[w].windowBusyNanos += record.busyNanos;
+            racesDone += record.races;
+            for (int d = 0; d < kProgressDrivers; ++d)
+                wins[d] += record.wins[d];
+        }
+    }
+}
+
+static string clockText(double seconds)
+{
+    long long s = (long long)max(seconds, 0.0);
+    char buf[32];
+    if (s >= 3600)
+        snprintf(buf, sizeof(buf), "%lld:%02lld:%02lld", s / 3600, s / 60 % 60, s % 60);
+    else
+        snprintf(buf, sizeof(buf), "%lld:%02lld", s / 60, s % 60);
+    return buf;
+}
+
+void ProgressDashboard::draw(bool final)
+{
+    auto now = chrono::steady_clock::now();
+    double elapsed = chrono::duration<double>(now - startTime).count();
+    double window = chrono::duration<double>(now - windowStart).count();
+
+    double windowRate = window > 0.0 ? (racesDone - windowStartRaces) / window : 0.0;
+    smoothedRate = smoothedRate > 0.0 ? 0.7 * smoothedRate + 0.3 * windowRate : windowRate;
+    double eta = smoothedRate > 0.0 ? (totalRaces - racesDone) / smoothedRate : 0.0;
+
+    // Move back over the previous frame and overwrite it in place
+    if (linesDrawn > 0)
+        fprintf(stderr, "\033[%dA", linesDrawn);
+    int lines = 0;
+
+    fprintf(stderr, "\033[K%lld/%lld races  %5.1f%%  %.0f races/s  %s %s\n", racesDone, totalRaces,
+            100.0 * racesDone / max(totalRaces, 1LL), final ? racesDone / max(elapsed, 1e-9) : smoothedRate,
+            final ? "done in" : "ETA", clockText(final ? elapsed : eta).c_str());
+    lines++;
+
+    // Leaders by wins so far, with the player always on the board
+
+    auto &drivers = driverCatalog();
+    vector<int> order;
+    for (int d = 0; d < (int)min<size_t>(drivers.size(), kProgressDrivers); ++d)
+        order.push_back(d);
+    sort(order.begin(), order.end(), [&](int a, int b) { return wins[a] > wins[b]; });
+    // Always six rows so the frame height never changes
+    if (order.size() > 6)
+        order.resize(6);
+    if (playerDriver >= 0 && playerDriver < (int)wins.size() && !order.empty() &&
+        find(order.begin(), order.end(), playerDriver) == order.end())
+        order.back() = playerDriver;
+    for (int d : order)
+    {
+        fprintf(stderr, "\033[K  %-18s %6.2f%% wins%s\n", drivers[d]->name.c_str(),
+                100.0 * wins[d] / max(racesDone, 1LL), d == playerDriver ? "  <- you" : "");
+        lines++;
+    }
+
+    // Share of the last window each worker spent simulating
+
+    for (size_t w = 0; w < totals.size(); ++w)
+    {
+        double busy = window > 0.0 ? clampVal(totals[w].windowBusyNanos / (window * 1e9), 0.0, 1.0) : 0.0;
+        if (final)
+            busy = elapsed > 0.0 ? clampVal(totals[w].busyNanos / (elapsed * 1e9), 0.0, 1.0) : 0.0;
+        int filled = (int)(busy * 20 + 0.5);
+        fprintf(stderr, "\033[K  worker %-2zu [%s%s] %3.0f%%  %lld races\n", w, string(filled, '#').c_str(),
+                string(20 - filled, '.').c_str(), 100.0 * busy, totals[w].races);
+        totals[w].windowBusyNanos = 0;
+        lines++;
+    }
+
+    fflush(stderr);
+    linesDrawn = lines;
+    windowStart = now;
+    windowStartRaces = racesDone;
+}
@@ -0,0 +1,132 @@
+// F1 TERMINAL RACER 2025 - LIVE DASHBOARD
+// Console progress for long batch runs, fed through per-worker ring buffers.
+
+#ifndef F1DASHBOARD_H
+#define F1DASHBOARD_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ---------- Ring Buffer ----------
+
+// Bounded single-producer single-consumer queue. Neither side ever waits;
+// each keeps a cached copy of the other's index so the shared cache lines
+// are only touched when the ring looks full or empty.
+template <class T, std::size_t N>
+class SpscRing
+{
+    static_assert((N & (N - 1)) == 0, "ring capacity must be a power of two");
+
+public:
+    bool tryPush(const T &item)
+    {
+        std::size_t head = writeIndex.load(std::memory_order_relaxed);
+        if (head - cachedRead == N)
+        {
+            cachedRead = readIndex.load(std::memory_order_acquire);
+            if (head - cachedRead == N)
+                return false;
+        }
+        slots[head & (N - 1)] = item;
+        writeIndex.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T &item)
+    {
+        std::size_t tail = readIndex.load(std::memory_order_relaxed);
+        if (tail == cachedWrite)
+        {
+            cachedWrite = writeIndex.load(std::memory_order_acquire);
+            if (tail == cachedWrite)
+                return false;
+        }
+        item = slots[tail & (N - 1)];
+        readIndex.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    alignas(64) std::atomic<std::size_t> writeIndex{0};
+    std::size_t cachedRead = 0; // producer only
+    alignas(64) std::atomic<std::size_t> readIndex{0};
+    std::size_t cachedWrite = 0; // consumer only
+    alignas(64) T slots[N];
+};
+
+// ---------- Progress Records ----------
+
+const int kProgressDrivers = 32;
+
+// What one worker did since its last record.
+struct ProgressRecord
+{
+    std::uint32_t races = 0;
+    std::uint64_t busyNanos = 0;
+    std::uint32_t wins[kProgressDrivers] = {};
+
+    void fold(const ProgressRecord &other);
+};
+
+// ---------- Dashboard ----------
+
+// Workers call publish() once per chunk of races; it never blocks or locks.
+// If a worker's ring is full the record is kept and folded into its next
+// one, so nothing is lost, just shown late. A display thread drains the
+// rings and redraws to stderr, leaving stdout for the results.
+class ProgressDashboard
+{
+public:
+    ProgressDashboard(int workers, long long totalRaces, int playerDriver, int refreshMs = 250);
+    ~ProgressDashboard();
+
+    void start();
+    void stop(); // after the workers finish: drains the rest, draws the final frame
+
+    void publish(int worker, const ProgressRecord &record);
+
+private:
+    struct Slot
+    {
+        SpscRing<ProgressRecord, 256> ring;
+        ProgressRecord pending; // producer only
+        bool hasPending = false;
+    };
+
+    struct WorkerTotals
+    {
+        long long races = 0;
+        std::uint64_t busyNanos = 0, windowBusyNanos = 0;
+    };
+
+    void displayLoop();
+    void drain(bool final);
+    void draw(bool final);
+
+    std::vector<std::unique_ptr<Slot>> slots;
+    long long totalRaces;
+    int playerDriver;
+    int refreshMs;
+
+    // Display thread only
+    std::vector<WorkerTotals> totals;
+    std::vector<long long> wins;
+    long long racesDone = 0, windowStartRaces = 0;
+    double smoothedRate = 0.0;
+    int linesDrawn = 0;
+    std::chrono::steady_clock::time_point startTime, windowStart;
+
+    std::thread display;
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+};
+
+#endif
@@ -0,0 +1,252 @@
+// F1 TERMINAL RACER 2025 - RACE FLOW
+
+#include "f1flow.h"
+
+#include "f1policy.h"
+
+#include <algorithm>
+
+using namespace std;
+
+// ---------- Race Flow ----------
+
+RaceFlow::RaceFlow(RaceState &race, bool endurance, int showEvery)
+    : race(&race), start(race.field.get_allocator().resource()), length(race.field.get_allocator().resource()),
+      showEvery(max(showEvery, 1)), endurance(endurance)
+{
+    // Cars sit behind the line in grid order until the lights go out
+    int cars = (int)race.field.size();
+    start.resize(cars);
+    length.assign(cars, race.track ? race.track->baseLapSec : 90.0);
+    for (int i = 0; i < cars; ++i)
+        start[i] = race.field[i].cumulativeTime;
+    lastPlayerPos = race.field.empty() ? 0 : race.field[race.playerIndex].currentPos;
+    nextLap = race.lap + 1;
+}
+
+void RaceFlow::runLap(int action, mt19937 &gen)
+{
+    pmr::vector<Racer> &field = race->field;
+    lastPlayerPos = field[race->playerIndex].currentPos;
+    for (size_t i = 0; i < field.size(); ++i)
+        start[i] = field[i].cumulativeTime;
+    simulateLap(*race, action, gen);
+    for (size_t i = 0; i < field.size(); ++i)
+        length[i] = max(field[i].cumulativeTime - start[i], 1.0);
+    nextLap++;
+}
+
+FlowWait RaceFlow::suspendAtLap(mt19937 &gen)
+{
+    while (nextLap <= race->totalLaps)
+    {
+        // In between, the crew runs the car and boxes it when the tyres are gone
+        if (endurance && (nextLap - 1) % showEvery != 0 && nextLap != race->totalLaps)
+        {
+            runLap(race->field[race->playerIndex].tyre < 25.0 ? 3 : -1, gen);
+            continue;
+        }
+        wait = (endurance || isDecisionLap(nextLap)) ? FlowWait::Decision : FlowWait::Frame;
+        return wait;
+    }
+    wait = FlowWait::Finished;
+    return wait;
+}
+
+FlowWait RaceFlow::resume(int action, mt19937 &gen)
+{
+    switch (wait)
+    {
+    case FlowWait::Grid:
+        return suspendAtLap(gen);
+    case FlowWait::Frame:
+        runLap(-1, gen);
+        return suspendAtLap(gen);
+    case FlowWait::Decision:
+        runLap(action, gen);
+        return suspendAtLap(gen);
+    default:
+        return wait;
+    }
+}
+
+// ---------- Flow Scheduler ----------
+
+// The checks simulateRace makes before starting a race
+static bool validScenario(const RaceScenario &scenario)
+{
+    return scenario.track >= 0 && scenario.track < (int)trackCatalog().size() && scenario.playerDriver >= 0 &&
+           scenario.playerDriver < (int)driverCatalog().size() && scenario.totalLaps > 0 &&
+           (!scenario.policy || scenario.policy->sized());
+}
+
+static RaceState &startScenario(RaceState &race, const RaceScenario &scenario, uint64_t seed)
+{
+    // Same setup as simulateRace, but the laps are left to the flow
+    mt19937 gen(mixSeed(seed));
+    const Driver &player = *driverCatalog()[scenario.playerDriver];
+    startRace(race, player, player.name, *trackCatalog()[scenario.track], scenario.totalLaps, gen);
+    race.policy = scenario.policy;
+    race.commonDraws = true;
+    race.antithetic = scenario.antithetic;
+    race.drawSeed = seed;
+    if (scenario.setup)
+        applyCarSetup(race.field[race.playerIndex], *race.track, *scenario.setup);
+    if (scenario.gridSize > 0)
+        applyGrid(race, scenario.grid, scenario.gridSize);
+    return race;
+}
+
+FlowScheduler::Slot::Slot(const RaceScenario &scenario, uint64_t seed, bool endurance, int showEvery)
+    : flow(startScenario(race, scenario, seed), endurance, showEvery)
+{
+}
+
+FlowScheduler::FlowScheduler(int threads, FlowHandler handler)
+    : threads(max(threads, 1)), handler(move(handler))
+{
+}
+
+FlowScheduler::~FlowScheduler()
+{
+    stop();
+}
+
+int FlowScheduler::add(const RaceScenario &scenario, uint64_t seed, bool endurance, int showEvery)
+{
+    if (!validScenario(scenario))
+        return -1;
+    auto slot = make_unique<Slot>(scenario, seed, endurance, showEvery);
+    int id;
+    {
+        lock_guard<mutex> guard(lock);
+        id = (int)races.size();
+        races.push_back(move(slot));
+        running++;
+    }
+    enqueue(id);
+    return id;
+}
+
+void FlowScheduler::start()
+{
+    // Make sure the catalogs exist before workers read them
+    fieldSize();
+    lock_guard<mutex> guard(lock);
+    stopping = false;
+    while ((int)pool.size() < threads)
+        pool.emplace_back(&FlowScheduler::worker, this);
+}
+
+void FlowScheduler::enqueue(int id)
+{
+    {
+        lock_guard<mutex> guard(lock);
+        ready.push_back(id);
+    }
+    wake.notify_one();
+}
+
+bool FlowScheduler::answer(int id, int action)
+{
+    {
+        lock_guard<mutex> guard(lock);
+        if (id < 0 || id >= (int)races.size() || !races[id]->parked)
+            return false;
+        races[id]->parked = false;
+        races[id]->action = action;
+    }
+    enqueue(id);
+    return true;
+}
+
+void FlowScheduler::worker()
+{
+    mt19937 gen(0); // never drawn from: scheduled races run on common draws
+    while (true)
+    {
+        int id;
+        Slot *slot;
+        {
+            unique_lock<mutex> guard(lock);
+            wake.wait(guard, [&] { return stopping || !ready.empty(); });
+            if (stopping)
+                return;
+            id = ready.front();
+            ready.pop_front();
+            slot = races[id].get();
+        }
+
+        // Only this worker holds the race until it is queued or parked again
+        if (slot->started)
+        {
+            slot->flow.resume(slot->action, gen);
+            resumes++;
+        }
+        slot->started = true;
+
+        int action = handler(id, slot->flow);
+        if (slot->flow.waiting() == FlowWait::Finished)
+        {
+            lock_guard<mutex> guard(lock);
+            finished++;
+            if (--running == 0)
+                done.notify_all();
+            continue;
+        }
+        if (action == kFlowAwaitInput)
+        {
+            lock_guard<mutex> guard(lock);
+            slot->parked = true;
+            parked++;
+            continue;
+        }
+        slot->action = action;
+        enqueue(id);
+    }
+}
+
+void FlowScheduler::wait()
+{
+    unique_lock<mutex> guard(lock);
+    done.wait(guard, [&] { return running == 0; });
+}
+
+void FlowScheduler::stop()
+{
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto &t : pool)
+        t.join();
+    pool.clear();
+}
+
+FlowSchedulerStats FlowScheduler::stats() const
+{
+    FlowSchedulerStats out;
+    out.resumes = resumes;
+    out.parked = parked;
+    lock_guard<mutex> guard(lock);
+    out.finished = finished;
+    return out;
+}
+
+const RaceState &FlowScheduler::race(int id) const
+{
+    lock_guard<mutex> guard(lock);
+    return races[id]->race;
+}
+
+size_t FlowScheduler::bytesPerRace(int id) const
+{
+    lock_guard<mutex> guard(lock);
+    const Slot &slot = *races[id];
+    const RaceState &r = slot.race;
+    return sizeof(Slot) + r.field.capacity() * sizeof(Racer) + r.order.capacity() * sizeof(int) +
+           r.conditions.capacity() * sizeof(LapConditions) + r.history.capacity() * sizeof(CarHistory) +
+           r.pitQueue.capacity() * sizeof(PitEvent) + r.boxFree.capacity() * sizeof(PitHold) +
+           2 * r.field.size() * sizeof(double);
+}
@@ -0,0 +1,141 @@
+// F1 TERMINAL RACER 2025 - RACE FLOW
+// Resumable race flow and a scheduler that runs many of them on a few threads.
+
+#ifndef F1FLOW_H
+#define F1FLOW_H
+
+#include "f1sim.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+// ---------- Race Flow ----------
+
+enum class FlowWait : std::uint8_t
+{
+    Grid,     // cars on the grid, lights not out yet
+    Frame,    // a lap to show; resume runs it in the current mode
+    Decision, // a lap to show that needs PUSH, SAVE or PIT first
+    Finished
+};
+
+// The lap loop of the interactive race, turned inside out: a hand-written
+// coroutine that suspends before every lap shown to the player and returns
+// what it waits on. Everything it needs across a suspension is below, so a
+// waiting race is its RaceState plus this, with no thread or stack held.
+//
+// Endurance races show one lap in showEvery (and always the last) and take
+// a decision on each; the crew drives the laps in between, boxing when the
+// tyres drop under 25%.
+class RaceFlow
+{
+public:
+    // race must be started; it stays owned by the caller.
+    explicit RaceFlow(RaceState &race, bool endurance = false, int showEvery = 1);
+
+    // action answers a Decision (1 PUSH, 2 SAVE, 3 PIT); other waits ignore it.
+    FlowWait resume(int action = -1, std::mt19937 &gen = rng);
+
+    FlowWait waiting() const { return wait; }
+    int lap() const { return nextLap; } // the lap on screen; totalLaps + 1 once finished
+    const RaceState &state() const { return *race; }
+
+    // For replaying the lap just run: each car's race time when it started,
+    // its length, and the player's position before it
+    double lapStart(int car) const { return start[car]; }
+    double lapLength(int car) const { return length[car]; }
+    int previousPosition() const { return lastPlayerPos; }
+
+private:
+    void runLap(int action, std::mt19937 &gen);
+    FlowWait suspendAtLap(std::mt19937 &gen);
+
+    RaceState *race;
+    std::pmr::vector<double> start, length; // from the race's arena
+    int nextLap = 1, lastPlayerPos = 0, showEvery = 1;
+    bool endurance = false;
+    FlowWait wait = FlowWait::Grid;
+};
+
+// ---------- Flow Scheduler ----------
+
+const int kFlowAwaitInput = -2;
+
+// Called on a worker thread each time a race suspends, Finished included.
+// Return the action to resume with straight away (bots), or
+// kFlowAwaitInput to park the race until answer() (humans).
+typedef std::function<int(int id, const RaceFlow &flow)> FlowHandler;
+
+struct FlowSchedulerStats
+{
+    long long resumes = 0, parked = 0;
+    int finished = 0;
+};
+
+// Races wait in one FIFO run queue; each worker pops one, resumes it to
+// its next suspension and either requeues it behind the others or parks
+// it. Races use common draws keyed on their seed, so a race gives the same
+// result whichever threads resume it and no generator is kept per race.
+class FlowScheduler
+{
+public:
+    FlowScheduler(int threads, FlowHandler handler);
+    FlowScheduler(const FlowScheduler &) = delete;
+    FlowScheduler &operator=(const FlowScheduler &) = delete;
+    ~FlowScheduler();
+
+    // Starts the race on the grid and queues it; returns its id, or -1 for
+    // a scenario simulateRace would reject. Races always run on common
+    // draws (see above); scenario.commonDraws is ignored.
+    int add(const RaceScenario &scenario, std::uint64_t seed, bool endurance = false, int showEvery = 1);
+    void start();
+    // Resumes a parked race with the player's action. False if the race is
+    // not parked: queued, running, finished, or not yet parked by the
+    // worker that just ran the handler, in which case try again.
+    bool answer(int id, int action);
+    // Blocks until every race added so far has finished.
+    void wait();
+    void stop();
+
+    // Only read a race once it has finished
+    const RaceState &race(int id) const;
+    FlowSchedulerStats stats() const;
+    // Bytes held by a race waiting in the queue, heap included
+    std::size_t bytesPerRace(int id) const;
+
+private:
+    struct Slot
+    {
+        Slot(const RaceScenario &scenario, std::uint64_t seed, bool endurance, int showEvery);
+        RaceState race;
+        RaceFlow flow;
+        int action = -1;
+        bool started = false; // the handler has seen the grid
+        bool parked = false;  // waiting for answer(); guarded by lock
+    };
+
+    void worker();
+    void enqueue(int id);
+
+    int threads;
+    FlowHandler handler;
+    std::vector<std::unique_ptr<Slot>> races;
+    std::deque<int> ready;
+    mutable std::mutex lock;
+    std::condition_variable wake, done;
+    std::vector<std::thread> pool;
+    bool stopping = false;
+    int running = 0; // races added and not yet finished
+    std::atomic<long long> resumes{0}, parked{0};
+    int finished = 0;
+};
+
+#endif
@@ -0,0 +1,101 @@
+// F1 TERMINAL RACER 2025 - LOOK-AHEAD
+
+#include "f1lookahead.h"
+
+#include <algorithm>
+
+using namespace std;
+
+// ---------- Look-Ahead ----------
+
+LookAhead::LookAhead(int threads)
+{
+    // Leave a core for the game itself
+    this->threads = threads > 0 ? threads : max(1, resolveThreadCount(0) - 1);
+}
+
+LookAhead::~LookAhead()
+{
+    stop();
+}
+
+void LookAhead::start(const RaceState &race)
+{
+    stop();
+    snapshot = race;
+    snapshot.history.clear(); // rollouts need no lap history
+    snapshot.perf = nullptr;  // counters belong to the game's thread
+    snapshot.commonDraws = true;
+    snapshot.antithetic = false;
+    for (auto &stat : stats)
+        stat = RunningStat();
+    cancel = false;
+    nextRollout = 0;
+    for (int t = 0; t < threads; ++t)
+        pool.emplace_back(&LookAhead::worker, this);
+}
+
+void LookAhead::stop()
+{
+    cancel = true;
+    for (auto &t : pool)
+        t.join();
+    pool.clear();
+}
+
+void LookAhead::worker()
+{
+    RaceArena arena;
+    RaceState race(arena.resource());
+    mt19937 gen(0); // only used by draws the common-draw path leaves out
+    while (!cancel.load(memory_order_relaxed))
+    {
+        uint64_t rollout = nextRollout++;
+        double position[kLookAheadOptions];
+        for (int option = 0; option < kLookAheadOptions; ++option)
+        {
+            race = snapshot;
+            race.drawSeed = rollout;
+            simulateLap(race, option + 1, gen);
+            while (race.lap < race.totalLaps && !cancel.load(memory_order_relaxed))
+            {
+                const Racer &me = race.field[race.playerIndex];
+                simulateLap(race, (isDecisionLap(race.lap + 1) && me.tyre < 30.0) ? 3 : -1, gen);
+            }
+            position[option] = race.field[race.playerIndex].currentPos;
+        }
+        if (cancel.load(memory_order_relaxed))
+            break; // the last rollout may be cut short
+
+        lock_guard<mutex> guard(lock);
+        for (int option = 0; option < kLookAheadOptions; ++option)
+            stats[option].add(position[option]);
+    }
+}
+
+LookAheadEstimate LookAhead::estimate(int action) const
+{
+    LookAheadEstimate out;
+    if (action < 1 || action > kLookAheadOptions)
+        return out;
+    lock_guard<mutex> guard(lock);
+    const RunningStat &stat = stats[action - 1];
+    out.rollouts = stat.n;
+    out.meanPosition = stat.mean;
+    out.halfWidth = stat.n > 1 ? confidenceZ(0.95) * stat.standardError() : 0.0;
+    return out;
+}
+
+int LookAhead::best() const
+{
+    lock_guard<mutex> guard(lock);
+    if (stats[0].n == 0)
+        return 0;
+    int best = 0;
+    for (int option = 1; option < kLookAheadOptions; ++option)
+    {
+        if (stats[option].mean < stats[best].mean)
+            best = option;
+    }
+    return best + 1;
+}
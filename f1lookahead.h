@@ -0,0 +1,58 @@
+// F1 TERMINAL RACER 2025 - LOOK-AHEAD
+// Background rollouts of the player's options while they decide.
+
+#ifndef F1LOOKAHEAD_H
+#define F1LOOKAHEAD_H
+
+#include "f1batch.h"
+#include "f1sim.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ---------- Look-Ahead ----------
+
+const int kLookAheadOptions = 3; // simulateLap actions 1 PUSH, 2 SAVE, 3 PIT
+
+struct LookAheadEstimate
+{
+    long long rollouts = 0;
+    double meanPosition = 0.0;
+    double halfWidth = 0.0; // 95% interval
+};
+
+// start() copies the race; workers then play each option for the coming lap
+// and race on to the flag, the player keeping the mode and boxing under 30%
+// tyre on later decision laps. Rollout k runs all three options on common
+// draws keyed by k (see RaceState::commonDraws), so the gaps between them
+// settle long before the absolute positions do. stop() cancels mid-lap.
+class LookAhead
+{
+public:
+    explicit LookAhead(int threads = 0);
+    LookAhead(const LookAhead &) = delete;
+    LookAhead &operator=(const LookAhead &) = delete;
+    ~LookAhead();
+
+    void start(const RaceState &race);
+    void stop();
+
+    LookAheadEstimate estimate(int action) const;
+    int best() const; // action with the lowest mean, 0 before any rollout
+
+private:
+    void worker();
+
+    int threads;
+    RaceState snapshot;
+    std::vector<std::thread> pool;
+    std::atomic<bool> cancel{false};
+    std::atomic<std::uint64_t> nextRollout{0};
+    mutable std::mutex lock;
+    RunningStat stats[kLookAheadOptions];
+};
+
+#endif
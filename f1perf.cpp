@@ -0,0 +1,211 @@
+// F1 TERMINAL RACER 2025 - PERF COUNTERS
+
+#include "f1perf.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
+
+using namespace std;
+
+// ---------- Phases and Events ----------
+
+const char *perfPhaseName(int phase)
+{
+    static const char *const names[kPerfPhases] = {"car loop", "interactions", "positions", "text", "render"};
+    return (phase >= 0 && phase < kPerfPhases) ? names[phase] : "?";
+}
+
+const char *perfEventName(int event)
+{
+    static const char *const names[kPerfEvents] = {"cycles", "instr", "l1d-miss", "llc-miss", "br-miss"};
+    return (event >= 0 && event < kPerfEvents) ? names[event] : "?";
+}
+
+void PerfTotals::merge(const PerfTotals &other)
+{
+    races += other.races;
+    for (int p = 0; p < kPerfPhases; ++p)
+    {
+        calls[p] += other.calls[p];
+        nanos[p] += other.nanos[p];
+        for (int e = 0; e < kPerfEvents; ++e)
+            counts[p][e] += other.counts[p][e];
+    }
+    eventMask |= other.eventMask;
+}
+
+// ---------- Counters ----------
+
+#ifdef __linux__
+
+PerfCounters::~PerfCounters()
+{
+    for (int fd : fds)
+    {
+        if (fd >= 0)
+            close(fd);
+    }
+}
+
+static int openEvent(uint32_t type, uint64_t config, int groupFd)
+{
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = (groupFd < 0); // the leader starts the whole group
+    attr.exclude_kernel = 1;       // user space only, allowed at perf_event_paranoid 2
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0);
+}
+
+bool PerfCounters::open()
+{
+    static const struct
+    {
+        uint32_t type;
+        uint64_t config;
+    } events[kPerfEvents] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                 (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+        {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                 (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    };
+
+    // Whatever the CPU supports joins the group; the rest read as missing
+    for (int e = 0; e < kPerfEvents; ++e)
+    {
+        groupSlot[e] = -1;
+        fds[e] = openEvent(events[e].type, events[e].config, leader);
+        if (fds[e] < 0)
+        {
+            int err = errno;
+            if (why.empty())
+            {
+                why = string(perfEventName(e)) + ": " + strerror(err);
+                if (err == ENOENT || err == EOPNOTSUPP)
+                    why += ", not supported by this CPU or VM";
+                else if (err == EACCES || err == EPERM)
+                    why += ", see /proc/sys/kernel/perf_event_paranoid";
+            }
+            continue;
+        }
+        if (leader < 0)
+            leader = fds[e];
+        groupSlot[e] = groupSize++;
+        totals.eventMask |= 1u << e;
+    }
+    if (leader < 0)
+        return false;
+
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    if (groupSize == kPerfEvents)
+        why.clear();
+    return true;
+}
+
+void PerfCounters::sample(double *values)
+{
+    for (int e = 0; e < kPerfEvents; ++e)
+        values[e] = 0.0;
+    if (leader < 0)
+        return;
+
+    // nr, time enabled, time running, then one value per group member
+    uint64_t buffer[3 + kPerfEvents];
+    if (read(leader, buffer, sizeof(buffer)) < (ssize_t)(3 * sizeof(uint64_t)))
+        return;
+    double scale = buffer[2] ? (double)buffer[1] / buffer[2] : 0.0;
+    for (int e = 0; e < kPerfEvents; ++e)
+    {
+        if (groupSlot[e] >= 0 && groupSlot[e] < (int)buffer[0])
+            values[e] = buffer[3 + groupSlot[e]] * scale;
+    }
+}
+
+#else
+
+PerfCounters::~PerfCounters()
+{
+}
+
+bool PerfCounters::open()
+{
+    why = "no hardware counter interface on this platform";
+    return false;
+}
+
+void PerfCounters::sample(double *values)
+{
+    for (int e = 0; e < kPerfEvents; ++e)
+        values[e] = 0.0;
+}
+
+#endif
+
+void PerfCounters::begin(int phase)
+{
+    sample(startCounts[phase]);
+    startTime[phase] = chrono::steady_clock::now();
+}
+
+void PerfCounters::end(int phase)
+{
+    auto now = chrono::steady_clock::now();
+    double values[kPerfEvents];
+    sample(values);
+    totals.calls[phase]++;
+    totals.nanos[phase] += (uint64_t)chrono::duration_cast<chrono::nanoseconds>(now - startTime[phase]).count();
+    for (int e = 0; e < kPerfEvents; ++e)
+        totals.counts[phase][e] += values[e] - startCounts[phase][e];
+}
+
+// ---------- Report ----------
+
+void writePerfReport(FILE *out, const PerfTotals &totals, const string &error)
+{
+    double races = (double)(totals.races ? totals.races : 1);
+    if (totals.eventMask == 0)
+        fprintf(out, "perf: hardware counters unavailable (%s), wall time only\n", error.c_str());
+    else if (!error.empty())
+        fprintf(out, "perf: some counters unavailable (%s)\n", error.c_str());
+
+    fprintf(out, "perf per race over %llu races:\n", (unsigned long long)totals.races);
+    fprintf(out, "  %-13s %9s %11s", "phase", "calls", "ns");
+    for (int e = 0; e < kPerfEvents; ++e)
+        fprintf(out, " %11s", perfEventName(e));
+    fprintf(out, " %6s\n", "IPC");
+
+    for (int p = 0; p < kPerfPhases; ++p)
+    {
+        if (totals.calls[p] == 0)
+            continue;
+        fprintf(out, "  %-13s %9.1f %11.0f", perfPhaseName(p), totals.calls[p] / races, totals.nanos[p] / races);
+        for (int e = 0; e < kPerfEvents; ++e)
+        {
+            if (totals.eventMask & (1u << e))
+                fprintf(out, " %11.0f", totals.counts[p][e] / races);
+            else
+                fprintf(out, " %11s", "-");
+        }
+        const double *c = totals.counts[p];
+        bool ipc = (totals.eventMask & 3u) == 3u && c[kPerfCycles] > 0.0;
+        if (ipc)
+            fprintf(out, " %6.2f\n", c[kPerfInstructions] / c[kPerfCycles]);
+        else
+            fprintf(out, " %6s\n", "-");
+    }
+}
@@ -0,0 +1,111 @@
+// F1 TERMINAL RACER 2025 - PERF COUNTERS
+// Optional hardware counters per simulation phase, via Linux perf_event_open.
+
+#ifndef F1PERF_H
+#define F1PERF_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// ---------- Phases and Events ----------
+
+enum PerfPhase
+{
+    kPhaseCarLoop,      // per-car lap time, pit and wear loop in simulateLap
+    kPhaseInteractions, // resolveInteractions
+    kPhasePositions,    // recomputePositions
+    kPhaseText,         // building report, advice and commentary text
+    kPhaseRender,       // drawing or writing it out
+    kPerfPhases
+};
+
+enum PerfEvent
+{
+    kPerfCycles,
+    kPerfInstructions,
+    kPerfL1Misses,  // L1 data read misses
+    kPerfLlcMisses, // last-level cache read misses
+    kPerfBranchMisses,
+    kPerfEvents
+};
+
+const char *perfPhaseName(int phase);
+const char *perfEventName(int event);
+
+// ---------- Totals ----------
+
+struct PerfTotals
+{
+    std::uint64_t races = 0;
+    std::uint64_t calls[kPerfPhases] = {};
+    std::uint64_t nanos[kPerfPhases] = {};
+    double counts[kPerfPhases][kPerfEvents] = {}; // scaled when the PMU was multiplexed
+    unsigned eventMask = 0;                       // bit per PerfEvent that was counted
+
+    void merge(const PerfTotals &other);
+};
+
+// ---------- Counters ----------
+
+// One thread's counter group: open() and every begin/end must happen on the
+// thread being measured. When the kernel, the CPU or a VM refuses the
+// counters, open() says why and begin/end still record wall time, so
+// callers never need a second code path. Phases may nest; an outer phase
+// includes the inner one. Each begin/end costs one read() syscall.
+class PerfCounters
+{
+public:
+    PerfCounters() = default;
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+    ~PerfCounters();
+
+    bool open();
+    const std::string &error() const { return why; }
+
+    void begin(int phase);
+    void end(int phase);
+    void raceDone() { totals.races++; }
+
+    PerfTotals totals;
+
+private:
+    // Counter values scaled for multiplexing, in PerfEvent order
+    void sample(double *values);
+
+    int leader = -1;
+    int fds[kPerfEvents] = {-1, -1, -1, -1, -1};
+    int groupSlot[kPerfEvents] = {}; // position in the group read, -1 when not counted
+    int groupSize = 0;
+    std::string why;
+
+    double startCounts[kPerfPhases][kPerfEvents] = {};
+    std::chrono::steady_clock::time_point startTime[kPerfPhases];
+};
+
+// For callers whose counters are optional
+inline void perfBegin(PerfCounters *perf, int phase)
+{
+    if (perf)
+        perf->begin(phase);
+}
+
+inline void perfEnd(PerfCounters *perf, int phase)
+{
+    if (perf)
+        perf->end(phase);
+}
+
+inline void perfSwitch(PerfCounters *perf, int from, int to)
+{
+    perfEnd(perf, from);
+    perfBegin(perf, to);
+}
+
+// Per-race average of every phase and counter, "-" for counters that were
+// not available.
+void writePerfReport(FILE *out, const PerfTotals &totals, const std::string &error);
+
+#endif
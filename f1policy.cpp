@@ -0,0 +1,264 @@
+// F1 TERMINAL RACER 2025 - AI POLICY TABLES
+
+#include "f1policy.h"
+
+#include "f1batch.h"
+
+#include <cstdio>
+
+using namespace std;
+
+static const char kPolicyMagic[4] = {'F', '1', 'P', 'T'};
+static const uint32_t kPolicyVersion = 1;
+static const int kCellsPerDriver = kPolicyLapBuckets * kPolicyTyreBuckets * kPolicyVehicleBuckets * kPolicyGapBuckets;
+
+// ---------- Quantisation ----------
+
+int policyLapBucket(int lap, int totalLaps)
+{
+    if (totalLaps <= 0)
+        return 0;
+    return clampVal((lap - 1) * kPolicyLapBuckets / totalLaps, 0, kPolicyLapBuckets - 1);
+}
+
+int policyTyreBucket(double tyre)
+{
+    return clampVal((int)(tyre / 10.0), 0, kPolicyTyreBuckets - 1);
+}
+
+int policyVehicleBucket(double vehicle)
+{
+    return clampVal((int)((100.0 - vehicle) / 5.0), 0, kPolicyVehicleBuckets - 1);
+}
+
+int policyGapBucket(double gapAhead)
+{
+    if (gapAhead < 1.0)
+        return 0;
+    if (gapAhead < 3.0)
+        return 1;
+    if (gapAhead < 8.0)
+        return 2;
+    return 3;
+}
+
+// ---------- Policy Table ----------
+
+size_t PolicyTable::cellIndex(int track, int driver, int lapBucket, int tyreBucket, int vehicleBucket, int gapBucket) const
+{
+    size_t i = (size_t)track * driverCount + driver;
+    i = i * kPolicyLapBuckets + lapBucket;
+    i = i * kPolicyTyreBuckets + tyreBucket;
+    i = i * kPolicyVehicleBuckets + vehicleBucket;
+    return i * kPolicyGapBuckets + gapBucket;
+}
+
+bool PolicyTable::sized() const
+{
+    return trackCount >= 0 && driverCount >= 0 &&
+           actions.size() == (size_t)trackCount * driverCount * kCellsPerDriver;
+}
+
+int PolicyTable::decide(int track, const Racer &racer, int lap, int totalLaps, bool &willPit) const
+{
+    if (track < 0 || track >= trackCount || racer.driverId < 0 || racer.driverId >= driverCount)
+        return kPolicyNeutral;
+
+    uint8_t action = actions[cellIndex(track, racer.driverId, policyLapBucket(lap, totalLaps), policyTyreBucket(racer.tyre),
+                                       policyVehicleBucket(racer.vehicle), policyGapBucket(racer.gapAhead))];
+    if (action == kPolicyPit)
+    {
+        willPit = true;
+        return kPolicyNeutral;
+    }
+    return action;
+}
+
+// ---------- Build ----------
+
+// Plays one car from the cell's state to the flag against a rival of the
+// same driver gap seconds up the road. Every action sees the same seeds.
+static double rolloutScore(const Track &track, const Driver &driver, int lap, int totalLaps, double tyre, double vehicle,
+                           double gap, uint8_t action, const PolicyBuildOptions &options, uint64_t cellSeed)
+{
+    int ahead = 0;
+    double totalTime = 0.0;
+
+    for (int k = 0; k < options.rollouts; ++k)
+    {
+        mt19937 gen(mixSeed(cellSeed + (uint64_t)k));
+        Racer me, rival;
+        me.driver = rival.driver = &driver;
+        me.skill = rival.skill = driverSkillIndex(driver);
+        me.tyre = rival.tyre = tyre;
+        me.vehicle = rival.vehicle = vehicle;
+        me.cumulativeTime = gap;
+
+        for (int l = lap; l <= totalLaps; ++l)
+        {
+            int myMode = aiChooseStrategy(me, gen);
+            bool myPit = me.tyre < 30.0;
+            if (l == lap)
+            {
+                myMode = (action == kPolicyPit) ? kPolicyNeutral : action;
+                myPit = (action == kPolicyPit);
+            }
+            double myLap = computeLapTimeSeconds(me, track, myMode, false, gen) + (myPit ? track.pitStopTime : 0.0);
+            me.cumulativeTime += myLap;
+            applyWearAndDamage(me, myMode, myPit, gen);
+
+            int rivalMode = aiChooseStrategy(rival, gen);
+            bool rivalPit = rival.tyre < 30.0;
+            double rivalLap = computeLapTimeSeconds(rival, track, rivalMode, false, gen) + (rivalPit ? track.pitStopTime : 0.0);
+            rival.cumulativeTime += rivalLap;
+            applyWearAndDamage(rival, rivalMode, rivalPit, gen);
+        }
+
+        if (me.cumulativeTime < rival.cumulativeTime)
+            ++ahead;
+        totalTime += me.cumulativeTime - gap;
+    }
+
+    return (double)ahead / options.rollouts - 1e-4 * totalTime / options.rollouts;
+}
+
+void buildPolicyTable(PolicyTable &table, const PolicyBuildOptions &options)
+{
+    static const double gapCentres[kPolicyGapBuckets] = {0.5, 2.0, 5.0, 30.0};
+
+    auto &trackList = trackCatalog();
+    auto &driverList = driverCatalog();
+    table.trackCount = (int)trackList.size();
+    table.driverCount = (int)driverList.size();
+    table.actions.assign((size_t)table.trackCount * table.driverCount * kCellsPerDriver, kPolicyNeutral);
+
+    int totalLaps = max(options.totalLaps, 1);
+
+    // One job per (track, driver, lap bucket); every cell is written once
+    size_t jobs = (size_t)table.trackCount * table.driverCount * kPolicyLapBuckets;
+    parallelFor(jobs, options.threads, [&](size_t begin, size_t end)
+                {
+        for (size_t job = begin; job < end; ++job)
+        {
+            int lapBucket = (int)(job % kPolicyLapBuckets);
+            int driver = (int)(job / kPolicyLapBuckets % table.driverCount);
+            int track = (int)(job / kPolicyLapBuckets / table.driverCount);
+            int lap = 1 + (int)((lapBucket + 0.5) * totalLaps / kPolicyLapBuckets);
+
+            for (int t = 0; t < kPolicyTyreBuckets; ++t)
+                for (int v = 0; v < kPolicyVehicleBuckets; ++v)
+                    for (int g = 0; g < kPolicyGapBuckets; ++g)
+                    {
+                        size_t cell = table.cellIndex(track, driver, lapBucket, t, v, g);
+                        uint64_t cellSeed = options.seed * 0x9E3779B97F4A7C15ull + cell * (uint64_t)options.rollouts;
+                        double tyre = t * 10.0 + 5.0;
+                        double vehicle = 100.0 - (v * 5.0 + 2.5);
+
+                        uint8_t best = kPolicyNeutral;
+                        double bestScore = -1e18;
+                        for (uint8_t action = kPolicySave; action <= kPolicyPit; ++action)
+                        {
+                            double score = rolloutScore(*trackList[track], *driverList[driver], lap, totalLaps, tyre, vehicle,
+                                                        gapCentres[g], action, options, cellSeed);
+                            if (score > bestScore)
+                            {
+                                bestScore = score;
+                                best = action;
+                            }
+                        }
+                        table.actions[cell] = best;
+                    }
+        } });
+}
+
+// ---------- Storage ----------
+
+// FNV-1a over track and driver names so a table never meets another roster
+static uint32_t catalogFingerprint()
+{
+    uint32_t h = 2166136261u;
+    auto mix = [&](const string &s)
+    {
+        for (unsigned char ch : s)
+            h = (h ^ ch) * 16777619u;
+        h = (h ^ 0xFFu) * 16777619u;
+    };
+    for (auto *track : trackCatalog())
+        mix(track->name);
+    for (auto *driver : driverCatalog())
+        mix(driver->name);
+    return h;
+}
+
+struct PolicyFileHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t fingerprint;
+    uint16_t trackCount, driverCount;
+    uint8_t lapBuckets, tyreBuckets, vehicleBuckets, gapBuckets;
+};
+
+bool savePolicyTable(const PolicyTable &table, const string &path)
+{
+    FILE *f = fopen(path.c_str(), "wb");
+    if (!f)
+        return false;
+
+    PolicyFileHeader header = {};
+    copy(kPolicyMagic, kPolicyMagic + 4, header.magic);
+    header.version = kPolicyVersion;
+    header.fingerprint = catalogFingerprint();
+    header.trackCount = (uint16_t)table.trackCount;
+    header.driverCount = (uint16_t)table.driverCount;
+    header.lapBuckets = kPolicyLapBuckets;
+    header.tyreBuckets = kPolicyTyreBuckets;
+    header.vehicleBuckets = kPolicyVehicleBuckets;
+    header.gapBuckets = kPolicyGapBuckets;
+
+    // Four 2-bit actions per byte
+    vector<uint8_t> packed((table.actions.size() + 3) / 4, 0);
+    for (size_t i = 0; i < table.actions.size(); ++i)
+        packed[i / 4] |= (uint8_t)((table.actions[i] & 3u) << ((i % 4) * 2));
+
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+              fwrite(packed.data(), 1, packed.size(), f) == packed.size();
+    return fclose(f) == 0 && ok;
+}
+
+bool loadPolicyTable(PolicyTable &table, const string &path)
+{
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f)
+        return false;
+
+    PolicyFileHeader header;
+    bool ok = fread(&header, sizeof(header), 1, f) == 1 &&
+              equal(kPolicyMagic, kPolicyMagic + 4, header.magic) &&
+              header.version == kPolicyVersion &&
+              header.fingerprint == catalogFingerprint() &&
+              header.trackCount == trackCatalog().size() &&
+              header.driverCount == driverCatalog().size() &&
+              header.lapBuckets == kPolicyLapBuckets && header.tyreBuckets == kPolicyTyreBuckets &&
+              header.vehicleBuckets == kPolicyVehicleBuckets && header.gapBuckets == kPolicyGapBuckets;
+
+    // The header is only read when it was read whole and matched
+    size_t cells = 0;
+    vector<uint8_t> packed;
+    if (ok)
+    {
+        cells = (size_t)header.trackCount * header.driverCount * kCellsPerDriver;
+        packed.resize((cells + 3) / 4);
+        ok = fread(packed.data(), 1, packed.size(), f) == packed.size();
+    }
+    fclose(f);
+    if (!ok)
+        return false;
+
+    table.trackCount = header.trackCount;
+    table.driverCount = header.driverCount;
+    table.actions.resize(cells);
+    for (size_t i = 0; i < cells; ++i)
+        table.actions[i] = (packed[i / 4] >> ((i % 4) * 2)) & 3u;
+    return true;
+}
@@ -0,0 +1,65 @@
+// F1 TERMINAL RACER 2025 - AI POLICY TABLES
+// Offline-built lookup tables so AI cars decide in O(1) per lap.
+
+#ifndef F1POLICY_H
+#define F1POLICY_H
+
+#include "f1sim.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ---------- Quantisation ----------
+
+const int kPolicyLapBuckets = 8;
+const int kPolicyTyreBuckets = 10;
+const int kPolicyVehicleBuckets = 4;
+const int kPolicyGapBuckets = 4;
+
+// Actions stored per cell; SAVE/PUSH/NEUTRAL match the lap-time modes.
+const std::uint8_t kPolicySave = 0;
+const std::uint8_t kPolicyPush = 1;
+const std::uint8_t kPolicyNeutral = 2;
+const std::uint8_t kPolicyPit = 3;
+
+// ---------- Policy Table ----------
+
+struct PolicyTable
+{
+    int trackCount = 0, driverCount = 0;
+    std::vector<std::uint8_t> actions; // one cell per quantised state
+
+    bool empty() const { return actions.empty(); }
+    // actions holds exactly one cell per state of trackCount x driverCount
+    bool sized() const;
+    std::size_t cellIndex(int track, int driver, int lapBucket, int tyreBucket, int vehicleBucket, int gapBucket) const;
+
+    // Returns the lap-time mode for an AI car and sets willPit for a stop.
+    int decide(int track, const Racer &racer, int lap, int totalLaps, bool &willPit) const;
+};
+
+int policyLapBucket(int lap, int totalLaps);
+int policyTyreBucket(double tyre);
+int policyVehicleBucket(double vehicle);
+int policyGapBucket(double gapAhead);
+
+// ---------- Build & Storage ----------
+
+struct PolicyBuildOptions
+{
+    int rollouts = 32;               // simulated finishes per action and cell
+    int totalLaps = kDefaultRaceLaps; // race length the lap buckets are scaled to
+    int threads = 0;
+    std::uint64_t seed = 1;
+};
+
+// Each cell keeps the action that most often beats a rival starting the
+// cell's gap ahead, ties broken on expected time to the flag.
+void buildPolicyTable(PolicyTable &table, const PolicyBuildOptions &options);
+
+// 2 bits per cell on disk; the header records the catalog it was built for.
+bool savePolicyTable(const PolicyTable &table, const std::string &path);
+bool loadPolicyTable(PolicyTable &table, const std::string &path);
+
+#endif
@@ -0,0 +1,143 @@
+// F1 TERMINAL RACER 2025 - DRIVER RATINGS
+
+#include "f1rating.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+// Plackett-Luce strengths are natural-log odds; Elo counts in 10^(1/400)
+static const double kEloPerUnit = 400.0 / log(10.0);
+
+// ---------- Accumulator ----------
+
+void RatingEngine::Accumulator::addRace(const int *finishOrder, int count)
+{
+    int drivers = (int)strength.size();
+    if (count < 2)
+        return;
+    weight.resize(count);
+    suffix.resize(count + 1);
+
+    suffix[count] = 0.0;
+    for (int k = count - 1; k >= 0; --k)
+    {
+        int id = finishOrder[k];
+        weight[k] = (id >= 0 && id < drivers) ? exp(strength[id]) : 0.0;
+        suffix[k] = suffix[k + 1] + weight[k];
+    }
+
+    // Car k took part in the picks for P1..P(k+1), with chance w/S_j at pick
+    // j. Running sums of 1/S and 1/S^2 give each car's share in one pass.
+    double inverse = 0.0, inverseSq = 0.0;
+    for (int k = 0; k < count; ++k)
+    {
+        int id = finishOrder[k];
+        if (suffix[k] <= 0.0)
+            break;
+        inverse += 1.0 / suffix[k];
+        inverseSq += 1.0 / (suffix[k] * suffix[k]);
+        if (weight[k] == 0.0)
+            continue;
+        gradient[id] += 1.0 - weight[k] * inverse;
+        information[id] += weight[k] * inverse - weight[k] * weight[k] * inverseSq;
+        starts[id]++;
+    }
+    races++;
+}
+
+// ---------- Engine ----------
+
+RatingEngine::RatingEngine(int drivers, const RatingOptions &options)
+    : options(options), strength(drivers, 0.0), information(drivers, 0.0), pendingGradient(drivers, 0.0),
+      pendingInformation(drivers, 0.0), starts(drivers, 0)
+{
+}
+
+RatingEngine::Accumulator RatingEngine::accumulator() const
+{
+    lock_guard<mutex> guard(lock);
+    Accumulator acc;
+    acc.strength = strength;
+    acc.gradient.assign(strength.size(), 0.0);
+    acc.information.assign(strength.size(), 0.0);
+    acc.starts.assign(strength.size(), 0);
+    return acc;
+}
+
+void RatingEngine::merge(Accumulator &acc)
+{
+    lock_guard<mutex> guard(lock);
+    for (size_t d = 0; d < strength.size(); ++d)
+    {
+        pendingGradient[d] += acc.gradient[d];
+        pendingInformation[d] += acc.information[d];
+        starts[d] += acc.starts[d];
+    }
+    pendingRaces += acc.races;
+    totalRaces += acc.races;
+    if (pendingRaces >= options.stepRaces)
+        step();
+
+    acc.strength = strength;
+    fill(acc.gradient.begin(), acc.gradient.end(), 0.0);
+    fill(acc.information.begin(), acc.information.end(), 0.0);
+    fill(acc.starts.begin(), acc.starts.end(), 0);
+    acc.races = 0;
+}
+
+// Call with lock held
+void RatingEngine::step()
+{
+    double largest = 0.0, sum = 0.0;
+    int rated = 0;
+    for (size_t d = 0; d < strength.size(); ++d)
+    {
+        information[d] += pendingInformation[d];
+        if (information[d] > 0.0)
+        {
+            double move = pendingGradient[d] / information[d];
+            strength[d] += move;
+            largest = max(largest, fabs(move));
+            sum += strength[d];
+            rated++;
+        }
+        pendingGradient[d] = pendingInformation[d] = 0.0;
+    }
+
+    // Only differences are identified; keep the rated drivers centred on 1500
+    if (rated > 0)
+    {
+        for (size_t d = 0; d < strength.size(); ++d)
+        {
+            if (information[d] > 0.0)
+                strength[d] -= sum / rated;
+        }
+    }
+
+    pendingRaces = 0;
+    steps++;
+    lastStep = largest * kEloPerUnit;
+}
+
+RatingSnapshot RatingEngine::snapshot() const
+{
+    lock_guard<mutex> guard(lock);
+    RatingSnapshot out;
+    out.drivers.resize(strength.size());
+    for (size_t d = 0; d < strength.size(); ++d)
+    {
+        DriverRating &r = out.drivers[d];
+        r.driverId = (int)d;
+        r.elo = 1500.0 + strength[d] * kEloPerUnit;
+        r.stdError = information[d] > 0.0 ? kEloPerUnit / sqrt(information[d]) : numeric_limits<double>::infinity();
+        r.races = starts[d];
+    }
+    out.races = totalRaces;
+    out.steps = steps;
+    out.lastStep = lastStep;
+    out.converged = steps >= 2 && totalRaces >= options.minRaces && lastStep < options.tolerance;
+    return out;
+}
@@ -0,0 +1,86 @@
+// F1 TERMINAL RACER 2025 - DRIVER RATINGS
+// Driver strength learned from simulated classifications, on the Elo scale.
+
+#ifndef F1RATING_H
+#define F1RATING_H
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// ---------- Ratings ----------
+
+struct RatingOptions
+{
+    long long stepRaces = 4096; // races folded in before the ratings move
+    long long minRaces = 20000; // before they can count as converged
+    double tolerance = 0.5;     // Elo; converged once a step moves nobody further
+};
+
+struct DriverRating
+{
+    int driverId = -1;
+    double elo = 1500.0;
+    double stdError = 0.0; // Elo points, infinite until the driver has raced
+    long long races = 0;
+};
+
+struct RatingSnapshot
+{
+    std::vector<DriverRating> drivers; // indexed by driver id
+    long long races = 0;
+    int steps = 0;
+    double lastStep = 0.0; // largest move of the latest step, Elo
+    bool converged = false;
+};
+
+// A whole classification is one Plackett-Luce observation: the winner is
+// picked from the field in proportion to exp(strength), then P2 from the
+// rest, and so on. Gradient and information of that likelihood come out of
+// suffix sums in O(field size) per race, with every pair accounted for.
+//
+// Workers fold races into their own Accumulator against a copy of the
+// ratings and hand it to merge() now and then; that is the only lock.
+// Every stepRaces races the engine takes a Newton step scaled by all the
+// information seen so far, so steps shrink as evidence piles up and the
+// ratings settle on the maximum-likelihood fit.
+class RatingEngine
+{
+public:
+    class Accumulator
+    {
+    public:
+        // finishOrder holds count driver ids, winner first.
+        void addRace(const int *finishOrder, int count);
+        long long pending() const { return races; }
+
+    private:
+        friend class RatingEngine;
+
+        std::vector<double> strength, gradient, information;
+        std::vector<long long> starts;
+        std::vector<double> weight, suffix; // scratch, one per car
+        long long races = 0;
+    };
+
+    explicit RatingEngine(int drivers, const RatingOptions &options = RatingOptions());
+
+    Accumulator accumulator() const;
+    // Folds acc in and clears it, handing it the latest ratings.
+    void merge(Accumulator &acc);
+    RatingSnapshot snapshot() const;
+
+private:
+    void step();
+
+    mutable std::mutex lock;
+    RatingOptions options;
+    std::vector<double> strength, information;
+    std::vector<double> pendingGradient, pendingInformation;
+    std::vector<long long> starts;
+    long long totalRaces = 0, pendingRaces = 0;
+    int steps = 0;
+    double lastStep = 0.0;
+};
+
+#endif
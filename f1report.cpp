@@ -0,0 +1,212 @@
+// F1 TERMINAL RACER 2025 - RACE REPORTS
+
+#include "f1report.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+// ---------- Report Writer ----------
+
+ReportWriter::ReportWriter(FILE *out, size_t capacity) : out(out), buffer(max<size_t>(capacity, 4096))
+{
+}
+
+ReportWriter::~ReportWriter()
+{
+    if (out)
+        flush();
+}
+
+char *ReportWriter::reserve(size_t bytes)
+{
+    if (used + bytes > buffer.size())
+    {
+        if (out)
+            flush();
+        if (used + bytes > buffer.size())
+            buffer.resize(max(buffer.size() * 2, used + bytes));
+    }
+    return buffer.data() + used;
+}
+
+bool ReportWriter::flush()
+{
+    if (!out || used == 0)
+        return good;
+    if (fwrite(buffer.data(), 1, used, out) != used)
+        good = false;
+    used = 0;
+    return good;
+}
+
+void ReportWriter::text(string_view s)
+{
+    char *p = reserve(s.size());
+    memcpy(p, s.data(), s.size());
+    used += s.size();
+}
+
+void ReportWriter::repeat(char c, int count)
+{
+    if (count <= 0)
+        return;
+    char *p = reserve((size_t)count);
+    memset(p, c, (size_t)count);
+    used += (size_t)count;
+}
+
+void ReportWriter::integer(long long value, int width)
+{
+    char digits[24];
+    char *end = to_chars(digits, digits + sizeof(digits), value).ptr;
+    repeat(' ', width - (int)(end - digits));
+    text(string_view(digits, (size_t)(end - digits)));
+}
+
+void ReportWriter::integerLeft(long long value, int width)
+{
+    char *p = reserve(24);
+    char *end = to_chars(p, p + 24, value).ptr;
+    used += (size_t)(end - p);
+    repeat(' ', width - (int)(end - p));
+}
+
+void ReportWriter::fixed(double value, int decimals)
+{
+    char *p = reserve(64);
+    auto result = to_chars(p, p + 64, value, chars_format::fixed, decimals);
+    used += (size_t)(result.ptr - p);
+}
+
+void ReportWriter::time(double seconds, int width)
+{
+    char *p = reserve(kTimeChars);
+    char *end = formatTimeChars(p, seconds);
+    used += (size_t)(end - p);
+    repeat(' ', width - (int)(end - p));
+}
+
+void ReportWriter::padded(string_view s, int width, size_t maxChars)
+{
+    s = s.substr(0, min(s.size(), maxChars));
+    text(s);
+    repeat(' ', width - (int)s.size());
+}
+
+// ---------- Race Reports ----------
+
+void writeClassification(ReportWriter &w, const RaceState &race, const char *playerLabel)
+{
+    const Track &track = *race.track;
+    const Racer &player = race.field[race.playerIndex];
+
+    w.text("┌──────────────────────────────────────────┐\n");
+    w.text("│          🏁 RACE CLASSIFICATION          │\n");
+    w.text("│          ");
+    w.text(track.name);
+    w.repeat(' ', 21 - (int)track.name.size());
+    w.text("           │\n");
+    w.text("├──────────────────────────────────────────┤\n");
+    w.text("│                                          │\n");
+
+    static const char *const medals[] = {"🥇", "🥈", "🥉"};
+    for (int p = 0; p < (int)race.order.size(); ++p)
+    {
+        int i = race.order[p];
+        const Racer &r = race.field[i];
+        w.text("│     ");
+        w.text(p < 3 ? medals[p] : "  ");
+        w.text(" P");
+        w.integer(p + 1);
+        w.text(". ");
+        if (i == race.playerIndex && playerLabel)
+            w.padded(playerLabel, 18, 15);
+        else
+            w.padded(r.displayName, 18, 15);
+        w.time(r.cumulativeTime, 9);
+        w.text("   │\n");
+    }
+
+    const char *holder = race.fastestLapIndex >= 0 ? race.field[race.fastestLapIndex].displayName : "";
+    w.text("│                                          │\n");
+    w.text("│    🏅 Fastest Lap: ");
+    w.time(race.fastestLapTime, 12);
+    w.text(" (");
+    w.padded(holder, 8, 8);
+    w.text(")    │\n");
+    w.text("│    🛞 Your Pit Stops: ");
+    w.integerLeft(player.pitStops, 2);
+    w.text("                 │\n");
+    w.text("│    📈 Position: P");
+    w.integer(player.startingPos);
+    w.text(" → P");
+    w.integerLeft(player.currentPos, 2);
+    w.text("                 │\n");
+    w.text("│                                          │\n");
+    w.text("└──────────────────────────────────────────┘\n");
+}
+
+static void writeStintRow(ReportWriter &w, const StintSummary &stint, int number, bool running)
+{
+    w.text("│ ");
+    w.integer(number, 2);
+    w.text(" L");
+    w.integerLeft(stint.firstLap, 5);
+    w.integer(stint.laps, 4);
+    w.text(" ");
+    w.time(stint.averageLap(), 9);
+    w.time(stint.bestLap, 9);
+    w.integer(lround(stint.tyreStart), 3);
+    w.text("→");
+    w.integerLeft(lround(stint.tyreEnd), 3);
+    w.text(running ? "* │\n" : "  │\n");
+}
+
+void writeStintSummary(ReportWriter &w, const CarHistory &history)
+{
+    w.text("┌──────────────────────────────────────────┐\n");
+    w.text("│              STINT SUMMARY               │\n");
+    w.text("├──────────────────────────────────────────┤\n");
+    w.text("│  # FROM   LAPS AVG      BEST     TYRE    │\n");
+    for (int i = 0; i < history.stintCount(); ++i)
+        writeStintRow(w, history.stint(i), i + 1, false);
+    if (history.currentStint().laps > 0)
+        writeStintRow(w, history.currentStint(), history.stintCount() + 1, true);
+    w.text("└──────────────────────────────────────────┘\n");
+}
+
+void writeClassificationCsvHeader(ReportWriter &w)
+{
+    w.text("race,seed,track,position,driver,team,time,gap,pit_stops,player\n");
+}
+
+void writeClassificationCsv(ReportWriter &w, const RaceState &race, uint64_t raceNo, uint64_t seed)
+{
+    double winnerTime = race.order.empty() ? 0.0 : race.field[race.order[0]].cumulativeTime;
+    for (int p = 0; p < (int)race.order.size(); ++p)
+    {
+        const Racer &r = race.field[race.order[p]];
+        w.integer((long long)raceNo);
+        w.text(",");
+        w.integer((long long)seed);
+        w.text(",");
+        w.text(race.track->name);
+        w.text(",");
+        w.integer(p + 1);
+        w.text(",");
+        w.text(r.displayName);
+        w.text(",");
+        w.text(r.driver ? string_view(r.driver->team) : string_view());
+        w.text(",");
+        w.fixed(r.cumulativeTime, 3);
+        w.text(",");
+        w.fixed(r.cumulativeTime - winnerTime, 3);
+        w.text(",");
+        w.integer(r.pitStops);
+        w.text(race.order[p] == race.playerIndex ? ",1\n" : ",0\n");
+    }
+}
@@ -0,0 +1,64 @@
+// F1 TERMINAL RACER 2025 - RACE REPORTS
+// Classification text and CSV written through one large reusable buffer.
+
+#ifndef F1REPORT_H
+#define F1REPORT_H
+
+#include "f1sim.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string_view>
+#include <vector>
+
+// ---------- Report Writer ----------
+
+// Formats straight into its buffer with to_chars-style routines; nothing is
+// allocated per value. With a FILE it flushes in large writes whenever the
+// buffer fills, without one it grows and keeps everything (for workers that
+// hand finished chunks to a writer in order).
+class ReportWriter
+{
+public:
+    explicit ReportWriter(FILE *out = nullptr, std::size_t capacity = 1 << 20);
+    ~ReportWriter();
+
+    void text(std::string_view s);
+    void repeat(char c, int count);
+    void integer(long long value, int width = 0);        // right-aligned in width
+    void integerLeft(long long value, int width);        // left-aligned in width
+    void fixed(double value, int decimals);
+    void time(double seconds, int width = 0);            // m:ss.mmm, left-aligned in width
+    void padded(std::string_view s, int width, std::size_t maxChars = (std::size_t)-1);
+
+    bool flush();
+    bool ok() const { return good; }
+    std::string_view contents() const { return std::string_view(buffer.data(), used); }
+    void clear() { used = 0; }
+
+private:
+    char *reserve(std::size_t bytes);
+
+    FILE *out;
+    std::vector<char> buffer;
+    std::size_t used = 0;
+    bool good = true;
+};
+
+// ---------- Race Reports ----------
+
+// The end-of-race classification box shown by the game. playerLabel
+// replaces the player's name when given (the game prints "YOU").
+void writeClassification(ReportWriter &w, const RaceState &race, const char *playerLabel = nullptr);
+
+// Stint table for one car, boxed like the classification: laps, average
+// and best lap, tyre use. The running stint is marked with '*'.
+void writeStintSummary(ReportWriter &w, const CarHistory &history);
+
+// One row per car:
+// race,seed,track,position,driver,team,time,gap,pit_stops,player
+void writeClassificationCsvHeader(ReportWriter &w);
+void writeClassificationCsv(ReportWriter &w, const RaceState &race, std::uint64_t raceNo, std::uint64_t seed);
+
+#endif
@@ -0,0 +1,311 @@
+// F1 TERMINAL RACER 2025 - SCENARIO FILES
+
+#include "f1scenario.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// ---------- Parsing ----------
+
+static string_view trim(string_view text)
+{
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t'))
+        text.remove_prefix(1);
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r'))
+        text.remove_suffix(1);
+    return text;
+}
+
+// Cuts text at the first sep; the piece before it is returned trimmed
+static string_view takeField(string_view &text, char sep)
+{
+    size_t at = text.find(sep);
+    string_view field = text.substr(0, at);
+    text = (at == string_view::npos) ? string_view() : text.substr(at + 1);
+    return trim(field);
+}
+
+static bool parseNumber(string_view text, uint64_t &value)
+{
+    auto result = from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == errc() && result.ptr == text.data() + text.size();
+}
+
+bool ScenarioStream::parseLine(string_view line, StreamedScenario &out, string &why) const
+{
+    string_view trackName = takeField(line, ';');
+    string_view driverName = takeField(line, ';');
+    string_view strategy = takeField(line, ';');
+    string_view seeds = takeField(line, ';');
+    string_view grid = takeField(line, ';');
+    string_view laps = takeField(line, ';');
+    if (!trim(line).empty())
+    {
+        why = "too many fields";
+        return false;
+    }
+
+    out.scenario = RaceScenario();
+    out.trackName = trackName;
+    out.driverName = driverName;
+    out.scenario.track = findTrack(trackName);
+    out.scenario.playerDriver = findDriver(driverName);
+    out.scenario.strategy = strategy;
+    if (out.scenario.track < 0)
+    {
+        why = "unknown track";
+        return false;
+    }
+    if (out.scenario.playerDriver < 0)
+    {
+        why = "unknown driver";
+        return false;
+    }
+
+    // "A-B" or "N"
+    size_t dash = seeds.find('-');
+    bool seedsOk = (dash == string_view::npos)
+                       ? (out.seedBegin = 0, parseNumber(seeds, out.seedEnd))
+                       : parseNumber(trim(seeds.substr(0, dash)), out.seedBegin) &&
+                             parseNumber(trim(seeds.substr(dash + 1)), out.seedEnd);
+    if (!seedsOk || out.seedEnd < out.seedBegin)
+    {
+        why = "bad seed range";
+        return false;
+    }
+
+    out.scenario.grid = out.grid;
+    out.scenario.gridSize = 0;
+    while (!grid.empty())
+    {
+        string_view name = takeField(grid, ',');
+        int id = findDriver(name);
+        if (id < 0 || out.scenario.gridSize == kMaxGridOverride)
+        {
+            why = id < 0 ? "unknown driver on grid" : "grid too long";
+            return false;
+        }
+        out.grid[out.scenario.gridSize++] = id;
+    }
+
+    uint64_t lapCount = kDefaultRaceLaps;
+    if (!laps.empty() && (!parseNumber(laps, lapCount) || lapCount == 0 || lapCount > 10000))
+    {
+        why = "bad lap count";
+        return false;
+    }
+    out.scenario.totalLaps = (int)lapCount;
+    return true;
+}
+
+// ---------- Scenario Stream ----------
+
+ScenarioStream::~ScenarioStream()
+{
+    close();
+}
+
+#ifdef _WIN32
+
+bool ScenarioStream::open(const string &)
+{
+    return false;
+}
+
+void ScenarioStream::close()
+{
+}
+
+#else
+
+// Pages behind the cursor are handed back in steps this large
+static const size_t kReleaseStep = 64u << 20;
+
+bool ScenarioStream::open(const string &path)
+{
+    close();
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close();
+        return false;
+    }
+    lineNo = 0;
+    if (st.st_size == 0)
+        return true; // nothing to map, next() just reports the end
+
+    void *map = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED)
+    {
+        close();
+        return false;
+    }
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+    begin = cursor = released = (const char *)map;
+    end = begin + st.st_size;
+    return true;
+}
+
+void ScenarioStream::close()
+{
+    if (begin)
+        munmap((void *)begin, (size_t)(end - begin));
+    if (fd >= 0)
+        ::close(fd);
+    begin = cursor = end = released = nullptr;
+    fd = -1;
+}
+
+#endif
+
+bool ScenarioStream::next(StreamedScenario &out, string *errors)
+{
+    string why;
+    while (cursor < end)
+    {
+        const char *newline = (const char *)memchr(cursor, '\n', (size_t)(end - cursor));
+        const char *lineEnd = newline ? newline : end;
+        string_view line(cursor, (size_t)(lineEnd - cursor));
+        cursor = newline ? newline + 1 : end;
+        ++lineNo;
+
+#ifndef _WIN32
+        // Read-only pages re-fault from the file if a scenario still points
+        // at them, so dropping them only trims the resident set
+        if ((size_t)(cursor - released) >= kReleaseStep)
+        {
+            size_t drop = (size_t)(cursor - released) / kReleaseStep * kReleaseStep;
+            madvise((void *)released, drop, MADV_DONTNEED);
+            released += drop;
+        }
+#endif
+
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty())
+            continue;
+
+        if (parseLine(line, out, why))
+        {
+            out.line = lineNo;
+            return true;
+        }
+        if (errors)
+            *errors += "line " + to_string(lineNo) + ": " + why + "\n";
+    }
+    return false;
+}
+
+// ---------- Streaming Batch ----------
+
+struct StreamJob
+{
+    size_t index = 0;
+    StreamedScenario spec;
+    uint64_t nextSeed = 0;
+    int outstanding = 0;
+    BatchStats stats;
+
+    bool dispatched() const { return nextSeed >= spec.seedEnd; }
+};
+
+size_t runScenarioStream(ScenarioStream &stream, const StreamRunOptions &options,
+                         const function<void(const StreamedScenario &, const BatchStats &)> &onResult,
+                         const function<void(const string &)> &onError)
+{
+    uint64_t piece = max<uint64_t>(options.pieceSize, 1);
+    mutex lock;
+    shared_ptr<StreamJob> current;      // scenario whose seeds are being handed out
+    map<size_t, shared_ptr<StreamJob>> done; // finished, waiting on an earlier one
+    size_t parsed = 0, emitted = 0;
+    bool exhausted = false;
+    string errors;
+
+    // Call with lock held
+    auto finish = [&](const shared_ptr<StreamJob> &job)
+    {
+        done[job->index] = job;
+        for (auto it = done.begin(); it != done.end() && it->first == emitted; it = done.erase(it))
+        {
+            onResult(it->second->spec, it->second->stats);
+            ++emitted;
+        }
+    };
+
+    int threads = resolveThreadCount(options.threads);
+    auto worker = [&]()
+    {
+        while (true)
+        {
+            shared_ptr<StreamJob> job;
+            uint64_t seedBegin, seedEnd;
+            {
+                lock_guard<mutex> guard(lock);
+                while (!current || current->dispatched())
+                {
+                    current.reset();
+                    if (exhausted)
+                        return;
+                    auto next = make_shared<StreamJob>();
+                    errors.clear();
+                    bool more = stream.next(next->spec, &errors);
+                    if (!errors.empty() && onError)
+                        onError(errors);
+                    if (!more)
+                    {
+                        exhausted = true;
+                        return;
+                    }
+                    next->spec.scenario.grid = next->spec.grid;
+                    next->index = parsed++;
+                    next->nextSeed = next->spec.seedBegin;
+                    if (next->dispatched())
+                        finish(next); // empty seed range
+                    else
+                        current = next;
+                }
+
+                job = current;
+                seedBegin = job->nextSeed;
+                seedEnd = min(job->spec.seedEnd, seedBegin + piece);
+                job->nextSeed = seedEnd;
+                job->outstanding++;
+            }
+
+            BatchStats stats = simulateSeedRange(job->spec.scenario, seedBegin, seedEnd);
+
+            lock_guard<mutex> guard(lock);
+            job->stats.merge(stats);
+            if (--job->outstanding == 0 && job->dispatched())
+                finish(job);
+        }
+    };
+
+    // Make sure the catalogs exist before workers read them
+    fieldSize();
+    vector<thread> pool;
+    for (int t = 1; t < threads; ++t)
+        pool.emplace_back(worker);
+    worker();
+    for (auto &t : pool)
+        t.join();
+    return emitted;
+}
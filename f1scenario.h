@@ -0,0 +1,84 @@
+// F1 TERMINAL RACER 2025 - SCENARIO FILES
+// Memory-mapped scenario lists streamed straight into the batch engine.
+
+#ifndef F1SCENARIO_H
+#define F1SCENARIO_H
+
+#include "f1batch.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+// ---------- File Format ----------
+
+// One scenario per line, fields separated by ';', blank trailing fields
+// may be left out, '#' starts a comment:
+//
+//   track; driver; strategy; seeds; grid; laps
+//   Monaco; Max Verstappen; PSSB; 0-5000
+//   Spa; Lando Norris; ; 100-200; Lando Norris,Charles Leclerc; 30
+//
+// seeds is "A-B" for [A, B) or "N" for [0, N). grid lists drivers to line
+// up at the front, in order. Strategy text is never copied: scenarios point
+// straight into the mapping, which must stay open while they are in use.
+
+const int kMaxGridOverride = 24;
+
+struct StreamedScenario
+{
+    RaceScenario scenario;
+    std::uint64_t seedBegin = 0, seedEnd = 0;
+    std::size_t line = 0;
+    std::string_view trackName, driverName;
+    int grid[kMaxGridOverride]; // scenario.grid points here; re-point after copying
+};
+
+// ---------- Scenario Stream ----------
+
+// Walks the file once, front to back, parsing a line at a time from the
+// mapping. The kernel pages it in on demand and may drop pages behind the
+// cursor, so the file is never resident in full. POSIX only.
+class ScenarioStream
+{
+public:
+    ~ScenarioStream();
+
+    bool open(const std::string &path);
+    void close();
+
+    // Parses the next scenario; false at end of file. Malformed lines are
+    // skipped, each appending "line N: reason\n" to errors when given.
+    bool next(StreamedScenario &out, std::string *errors = nullptr);
+
+    std::size_t bytesRead() const { return (std::size_t)(cursor - begin); }
+    std::size_t size() const { return (std::size_t)(end - begin); }
+
+private:
+    bool parseLine(std::string_view line, StreamedScenario &out, std::string &why) const;
+
+    const char *begin = nullptr, *cursor = nullptr, *end = nullptr;
+    const char *released = nullptr; // pages before this were handed back
+    std::size_t lineNo = 0;
+    int fd = -1;
+};
+
+// ---------- Streaming Batch ----------
+
+struct StreamRunOptions
+{
+    int threads = 0;
+    std::uint64_t pieceSize = 1000; // seeds per unit of work, large ranges are split
+};
+
+// Workers pull pieces of work straight off the stream, so simulation
+// starts with the first line. onResult sees each scenario in file order as
+// soon as it and every scenario before it are done; only those in flight
+// are held in memory. Returns the number of scenarios run.
+std::size_t runScenarioStream(ScenarioStream &stream, const StreamRunOptions &options,
+                              const std::function<void(const StreamedScenario &, const BatchStats &)> &onResult,
+                              const std::function<void(const std::string &)> &onError);
+
+#endif
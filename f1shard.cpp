@@ -0,0 +1,300 @@
+// F1 TERMINAL RACER 2025 - SHARDED SWEEPS
+
+#include "f1shard.h"
+
+#ifndef _WIN32
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <deque>
+
+using namespace std;
+
+#ifdef _WIN32
+
+bool runShardedSweep(const vector<RaceScenario> &, const SweepOptions &, SweepReport &)
+{
+    return false;
+}
+
+#else
+
+// ---------- Wire Format ----------
+
+// Workers are forked from the coordinator, so both ends share one binary
+// and the scenario list; only shard coordinates and totals cross the wire.
+const uint32_t kStopShard = 0xFFFFFFFFu;
+
+struct ShardRequest
+{
+    uint32_t shard;
+    uint32_t scenario;
+    uint64_t seedBegin, seedEnd;
+};
+
+struct ShardReply
+{
+    uint32_t shard;
+    BatchStats stats;
+};
+
+static bool sendAll(int fd, const void *data, size_t size)
+{
+    const char *p = (const char *)data;
+    while (size > 0)
+    {
+        ssize_t n = send(fd, p, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+static bool recvAll(int fd, void *data, size_t size)
+{
+    char *p = (char *)data;
+    while (size > 0)
+    {
+        ssize_t n = recv(fd, p, size, 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+// ---------- Worker ----------
+
+static void workerMain(int fd, const vector<RaceScenario> &scenarios)
+{
+    ShardRequest request;
+    while (recvAll(fd, &request, sizeof(request)) && request.shard != kStopShard)
+    {
+        ShardReply reply;
+        reply.shard = request.shard;
+        if (request.scenario < scenarios.size())
+            reply.stats = simulateSeedRange(scenarios[request.scenario], request.seedBegin, request.seedEnd);
+        if (!sendAll(fd, &reply, sizeof(reply)))
+            break;
+    }
+    _exit(0);
+}
+
+// ---------- Coordinator ----------
+
+struct WorkerProc
+{
+    pid_t pid = -1;
+    int fd = -1;
+    long long shard = -1; // in flight, -1 when idle
+};
+
+static bool spawnWorker(WorkerProc &worker, vector<WorkerProc> &all, const vector<RaceScenario> &scenarios)
+{
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0)
+        return false;
+
+    fflush(stdout);
+    fflush(stderr);
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        close(sv[0]);
+        close(sv[1]);
+        return false;
+    }
+    if (pid == 0)
+    {
+        close(sv[0]);
+        for (auto &other : all)
+        {
+            if (other.fd >= 0)
+                close(other.fd);
+        }
+        workerMain(sv[1], scenarios);
+    }
+
+    close(sv[1]);
+    worker.pid = pid;
+    worker.fd = sv[0];
+    worker.shard = -1;
+    return true;
+}
+
+static void retireWorker(WorkerProc &worker, bool kill)
+{
+    if (worker.fd >= 0)
+        close(worker.fd);
+    if (worker.pid > 0)
+    {
+        if (kill)
+            ::kill(worker.pid, SIGKILL);
+        waitpid(worker.pid, nullptr, 0);
+    }
+    worker.fd = -1;
+    worker.pid = -1;
+    worker.shard = -1;
+}
+
+bool runShardedSweep(const vector<RaceScenario> &scenarios, const SweepOptions &options, SweepReport &report)
+{
+    report = SweepReport();
+    report.perScenario.assign(scenarios.size(), BatchStats());
+
+    uint64_t span = options.seedEnd > options.seedBegin ? options.seedEnd - options.seedBegin : 0;
+    uint64_t shardSize = max<uint64_t>(options.shardSize, 1);
+    uint64_t shardsPerScenario = (span + shardSize - 1) / shardSize;
+    uint64_t totalShards = shardsPerScenario * scenarios.size();
+    if (totalShards == 0)
+    {
+        report.complete = true;
+        return true;
+    }
+    if (totalShards >= kStopShard)
+        return false;
+
+    // Make sure the catalogs are built once, before forking
+    fieldSize();
+
+    deque<uint32_t> pending;
+    for (uint32_t s = 0; s < totalShards; ++s)
+        pending.push_back(s);
+    vector<BatchStats> results(totalShards);
+    vector<char> finished(totalShards, 0);
+    long long done = 0;
+
+    int workerCount = (int)min<uint64_t>(resolveThreadCount(options.workers), totalShards);
+    vector<WorkerProc> workers(workerCount);
+    for (auto &w : workers)
+        spawnWorker(w, workers, scenarios);
+
+    int respawns = 0;
+    bool injected = false;
+
+    auto fail = [&](WorkerProc &w)
+    {
+        if (w.shard >= 0)
+            pending.push_front((uint32_t)w.shard);
+        retireWorker(w, true);
+        report.workerFailures++;
+        if (respawns < options.maxRespawns && spawnWorker(w, workers, scenarios))
+            respawns++;
+    };
+
+    vector<pollfd> fds;
+    vector<int> owner;
+    while (done < (long long)totalShards)
+    {
+        // Keep one shard in flight per live worker
+
+        for (auto &w : workers)
+        {
+            if (w.fd < 0 || w.shard >= 0 || pending.empty())
+                continue;
+            uint32_t shard = pending.front();
+            pending.pop_front();
+
+            ShardRequest request;
+            request.shard = shard;
+            request.scenario = (uint32_t)(shard / shardsPerScenario);
+            request.seedBegin = options.seedBegin + (shard % shardsPerScenario) * shardSize;
+            request.seedEnd = min(options.seedEnd, request.seedBegin + shardSize);
+            w.shard = shard;
+            if (!sendAll(w.fd, &request, sizeof(request)))
+                fail(w);
+        }
+
+        fds.clear();
+        owner.clear();
+        for (int i = 0; i < workerCount; ++i)
+        {
+            if (workers[i].fd >= 0 && workers[i].shard >= 0)
+            {
+                fds.push_back({workers[i].fd, POLLIN, 0});
+                owner.push_back(i);
+            }
+        }
+        if (fds.empty())
+        {
+            if (any_of(workers.begin(), workers.end(), [](const WorkerProc &w) { return w.fd >= 0; }))
+                continue;
+            break; // every worker lost and out of respawns
+        }
+
+        if (poll(fds.data(), fds.size(), -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
+        for (size_t k = 0; k < fds.size(); ++k)
+        {
+            if (!fds[k].revents)
+                continue;
+            WorkerProc &w = workers[owner[k]];
+
+            ShardReply reply;
+            if (!recvAll(w.fd, &reply, sizeof(reply)) || reply.shard != (uint32_t)w.shard)
+            {
+                fail(w);
+                continue;
+            }
+
+            if (!finished[reply.shard])
+            {
+                finished[reply.shard] = 1;
+                results[reply.shard] = reply.stats;
+                done++;
+            }
+            w.shard = -1;
+
+            if (!injected && options.killAfterShards >= 0 && done >= options.killAfterShards && done < (long long)totalShards)
+            {
+                // Take down a busy worker on the next round to exercise recovery
+                injected = true;
+                for (auto &victim : workers)
+                {
+                    if (victim.pid > 0 && &victim != &w)
+                    {
+                        ::kill(victim.pid, SIGKILL);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    for (auto &w : workers)
+    {
+        if (w.fd >= 0)
+        {
+            ShardRequest stop = {kStopShard, 0, 0, 0};
+            sendAll(w.fd, &stop, sizeof(stop));
+        }
+        retireWorker(w, false);
+    }
+
+    // Merge in shard order so the report never depends on scheduling
+    for (uint64_t s = 0; s < totalShards; ++s)
+        report.perScenario[s / shardsPerScenario].merge(results[s]);
+    report.shards = done;
+    report.complete = (done == (long long)totalShards);
+    return report.complete;
+}
+
+#endif
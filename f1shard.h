@@ -0,0 +1,39 @@
+// F1 TERMINAL RACER 2025 - SHARDED SWEEPS
+// Coordinator that fans a scenario sweep out to local worker processes.
+
+#ifndef F1SHARD_H
+#define F1SHARD_H
+
+#include "f1batch.h"
+
+#include <cstdint>
+#include <vector>
+
+// ---------- Sharded Sweep ----------
+
+struct SweepOptions
+{
+    int workers = 0;              // worker processes, <= 0 uses every core
+    std::uint64_t seedBegin = 0;  // every scenario runs seeds [seedBegin, seedEnd)
+    std::uint64_t seedEnd = 10000;
+    std::uint64_t shardSize = 1000;
+    int maxRespawns = 8;          // replacement workers after crashes
+    int killAfterShards = -1;     // fault injection: SIGKILL one worker once this many shards are in
+};
+
+struct SweepReport
+{
+    std::vector<BatchStats> perScenario;
+    long long shards = 0;
+    int workerFailures = 0;
+    bool complete = false;
+};
+
+// Splits each scenario's seed range into shards and hands them, one in
+// flight per worker, to forked processes over socketpairs. A worker that
+// dies has its shard requeued and is replaced. Shard results are integer
+// sums, so the merged report is identical for any worker count or failure
+// pattern. POSIX only; returns false elsewhere or if every worker is lost.
+bool runShardedSweep(const std::vector<RaceScenario> &scenarios, const SweepOptions &options, SweepReport &report);
+
+#endif
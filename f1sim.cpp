@@ -0,0 +1,953 @@
+// F1 TERMINAL RACER 2025 - SIMULATION CORE
+
+#include "f1sim.h"
+
+#include "f1perf.h"
+#include "f1policy.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <numeric>
+
+using namespace std;
+
+// ---------- Utility & Globals ----------
+
+std::mt19937 rng((unsigned)chrono::high_resolution_clock::now().time_since_epoch().count());
+
+char *formatTimeChars(char *first, double seconds)
+{
+    if (seconds < 0.0)
+        seconds = 0.0;
+    long long total_ms = llround(seconds * 1000.0);
+    int ms = (int)(total_ms % 1000);
+    long long total_s = total_ms / 1000;
+    int s = (int)(total_s % 60);
+    long long m = total_s / 60;
+
+    char *p = to_chars(first, first + kTimeChars - 7, m).ptr;
+    *p++ = ':';
+    *p++ = (char)('0' + s / 10);
+    *p++ = (char)('0' + s % 10);
+    *p++ = '.';
+    *p++ = (char)('0' + ms / 100);
+    *p++ = (char)('0' + ms / 10 % 10);
+    *p++ = (char)('0' + ms % 10);
+    return p;
+}
+
+string formatTime(double seconds)
+{
+    char buf[kTimeChars];
+    return string(buf, formatTimeChars(buf, seconds));
+}
+
+// ---------- Game Content ----------
+
+map<string, Team> teams = {
+    {"Red Bull", {"Red Bull Racing", 9.8, "RB21", 185000000}},
+    {"Ferrari", {"Scuderia Ferrari", 9.2, "SF-25", 145000000}},
+    {"Mercedes", {"Mercedes-AMG", 9.0, "W16", 155000000}},
+    {"McLaren", {"McLaren", 8.7, "MCL38", 135000000}},
+    {"Aston Martin", {"Aston Martin", 8.5, "AMR24", 125000000}},
+    {"Alpine", {"Alpine", 7.8, "A524", 95000000}},
+    {"RB", {"RB", 7.5, "VCARB01", 85000000}},
+    {"Haas", {"Haas", 7.2, "VF-24", 80000000}},
+    {"Williams", {"Williams", 7.0, "FW46", 75000000}},
+    {"Sauber", {"Kick Sauber", 6.8, "C44", 70000000}}};
+
+map<string, vector<Driver>> teamDrivers = {
+    {"Red Bull", {{"Max Verstappen", 10, 10, 10, 10, 9, 9, "Red Bull"}, {"Sergio Perez", 8, 7, 8, 8, 7, 8, "Red Bull"}}},
+    {"Ferrari", {{"Charles Leclerc", 9, 9, 8, 8, 8, 8, "Ferrari"}, {"Carlos Sainz", 8, 8, 7, 9, 7, 8, "Ferrari"}}},
+    {"Mercedes", {{"Lewis Hamilton", 9, 8, 8, 9, 7, 9, "Mercedes"}, {"George Russell", 8, 8, 8, 8, 8, 8, "Mercedes"}}},
+    {"McLaren", {{"Lando Norris", 9, 9, 9, 9, 8, 8, "McLaren"}, {"Oscar Piastri", 8, 8, 8, 8, 7, 7, "McLaren"}}},
+    {"Aston Martin", {{"Fernando Alonso", 8, 8, 8, 9, 7, 9, "Aston Martin"}, {"Lance Stroll", 6, 7, 7, 6, 7, 6, "Aston Martin"}}},
+    {"Alpine", {{"Pierre Gasly", 7, 7, 7, 7, 8, 7, "Alpine"}, {"Esteban Ocon", 7, 7, 7, 8, 7, 7, "Alpine"}}},
+    {"RB", {{"Yuki Tsunoda", 8, 6, 7, 7, 8, 6, "RB"}, {"Daniel Ricciardo", 7, 7, 8, 7, 7, 7, "RB"}}},
+    {"Haas", {{"Nico Hulkenberg", 7, 8, 7, 8, 6, 8, "Haas"}, {"Kevin Magnussen", 7, 6, 7, 6, 8, 6, "Haas"}}},
+    {"Williams", {{"Alex Albon", 7, 7, 8, 7, 7, 7, "Williams"}, {"Logan Sargeant", 6, 6, 6, 6, 6, 6, "Williams"}}},
+    {"Sauber", {{"Valtteri Bottas", 7, 7, 6, 8, 6, 8, "Sauber"}, {"Zhou Guanyu", 6, 7, 6, 7, 6, 7, "Sauber"}}}};
+
+map<string, Track> tracks = {
+    {"Monaco", {
+        "Monaco Street Circuit", 
+        "Monaco", 
+        "│               _____                 │\n"
+        "│              /     \\                │\n"
+        "│   __________/       │               │\n"
+        "│  │                  │               │\n"
+        "│  │                  │               │\n" 
+        "│  │         ________/                │\n"
+        "│  │        │                         │\n"
+        "│  │         \\                        │\n"
+        "│   \\         \\                       │\n"
+        "│    \\_________│                      │",
+        78.5,  // lapDistance (km)
+        9,     // laps
+        11,    // corners
+        17.0   // pitstopTime
+    }},
+    
+    {"Spa", {
+        "Spa-Francorchamps", 
+        "Belgium", 
+        "│   _______                           │\n"
+        "│  /       \\_________                 │\n"
+        "│ /                   \\               │\n"
+        "│ |                    |              │\n"
+        "│ |                    |              │\n"
+        "│  \\                  /               │\n"
+        "│   \\________ _______/                │\n"
+        "│           \\_/                       │", 
+        99.0,  // lapDistance (km)
+        8,     // laps
+        14,    // corners
+        21.0   // pitstopTime
+    }},
+    
+    {"Silverstone", {
+        "Silverstone Circuit", 
+        "UK", 
+        "│    ____                             │\n"
+        "│   /    \\          ____              │\n"
+        "│  /      \\____    |    |             │\n"
+        "│ |      ______|   /    |             │\n"
+        "│ |     |_________|     |             │\n"
+        "│  \\                   /              │\n"
+        "│   \\_________________/               │", 
+        95.0,  // lapDistance (km)
+        6,     // laps
+        17,    // corners
+        20.0   // pitstopTime
+    }},
+    
+    {"Monza", {
+        "Autodromo Nazionale Monza", 
+        "Italy", 
+        "│   ____________________              │\n"
+        "│  |                    |             │\n"
+        "│  |                    |             │\n"
+        "│  |    __        __    |             │\n"
+        "│  |   |  |      |  |   |             │\n"
+        "│  |   |  |      |  |   |             │\n"
+        "│   \\__|  |______|  |__/              │", 
+        85.0,  // lapDistance (km)
+        5,     // laps
+        14,    // corners
+        24.0   // pitstopTime
+    }}
+};
+
+
+// ---------- Catalog ----------
+
+const vector<const Track *> &trackCatalog()
+{
+    static const vector<const Track *> catalog = []
+    {
+        vector<const Track *> v;
+        for (auto &track : tracks)
+            v.push_back(&track.second);
+        return v;
+    }();
+    return catalog;
+}
+
+const vector<const Driver *> &driverCatalog()
+{
+    static const vector<const Driver *> catalog = []
+    {
+        vector<const Driver *> v;
+        for (auto &team : teamDrivers)
+            for (auto &driver : team.second)
+                v.push_back(&driver);
+        return v;
+    }();
+    return catalog;
+}
+
+int findTrack(string_view key)
+{
+    int i = 0;
+    for (auto &track : tracks)
+    {
+        if (track.first == key || track.second.name == key)
+            return i;
+        ++i;
+    }
+    return -1;
+}
+
+int findTeam(string_view key)
+{
+    int i = 0;
+    for (auto &team : teams)
+    {
+        if (team.first == key)
+            return i;
+        ++i;
+    }
+    return -1;
+}
+
+int findDriver(string_view name)
+{
+    auto &catalog = driverCatalog();
+    for (int i = 0; i < (int)catalog.size(); ++i)
+    {
+        if (catalog[i]->name == name)
+            return i;
+    }
+    return -1;
+}
+
+// ---------- Core Logic ----------
+
+double driverSkillIndex(const Driver &d)
+{
+    return (d.speed + d.cornering + d.overtaking + d.consistency + d.aggression + d.strategy) / 6.0;
+}
+
+// Same mapping as uniform_real_distribution, so a draw from gen lands on the same value
+static double scaleDraw(double draw, double low, double high)
+{
+    return draw * (high - low) + low;
+}
+
+static double canonicalDraw(mt19937 &gen)
+{
+    return generate_canonical<double, numeric_limits<double>::digits>(gen);
+}
+
+double computeLapTimeSeconds(const Racer &racer, const Track &track, int mode, bool /*isPlayer*/, mt19937 &gen,
+                             const LapConditions &conditions)
+{
+    return computeLapTimeSeconds(racer, track, mode, canonicalDraw(gen), conditions);
+}
+
+double computeLapTimeSeconds(const Racer &racer, const Track &track, int mode, double draw,
+                             const LapConditions &conditions)
+{
+    double base = track.baseLapSec;
+    double skill = racer.skill;
+    double skillReduction = (skill - 7.0) * 0.6;
+
+    double tyreFactor = 1.0;
+    if (racer.tyre < 80.0)
+        tyreFactor += (80.0 - racer.tyre) * 0.0018;
+    if (racer.tyre < 60.0)
+        tyreFactor += 0.01;
+    if (racer.tyre < 40.0)
+        tyreFactor += 0.02;
+
+    double vehicleFactor = 1.0 + (100.0 - racer.vehicle) * 0.001;
+    double modeDelta = (mode == 1) ? -0.6 : ((mode == 0) ? 0.4 : 0.0);
+
+    double jitter = scaleDraw(draw, -0.6, 0.6);
+
+    double lap = base + skillReduction + modeDelta + racer.carPace + conditions.paceSeconds;
+    lap *= tyreFactor * vehicleFactor;
+    lap += jitter;
+
+    return max(lap, 30.0);
+}
+
+void applyWearAndDamage(Racer &racer, int mode, bool hadPitThisLap, mt19937 &gen, const LapConditions &conditions)
+{
+    bool draws = !hadPitThisLap && (mode == 1 || mode == 0);
+    applyWearAndDamage(racer, mode, hadPitThisLap, draws ? canonicalDraw(gen) : 0.0, conditions);
+}
+
+void applyWearAndDamage(Racer &racer, int mode, bool hadPitThisLap, double draw, const LapConditions &conditions)
+{
+    if (hadPitThisLap)
+    {
+        racer.tyre = 100.0;
+        racer.vehicle = clampVal(racer.vehicle + 2.0, 0.0, 100.0);
+        return;
+    }
+
+    double tyreDrop = 2.5;
+    double vehicleDrop = 0.0;
+
+    if (mode == 1)
+    {
+        tyreDrop = 5.0 + scaleDraw(draw, -0.5, 1.5);
+        vehicleDrop = 0.8;
+    }
+    else if (mode == 0)
+    {
+        tyreDrop = 1.8 + scaleDraw(draw, -0.4, 0.6);
+        vehicleDrop = 0.2;
+    }
+
+    racer.tyre = clampVal(racer.tyre - tyreDrop * racer.tyreWearScale * conditions.wearScale, 0.0, 100.0);
+    racer.vehicle = clampVal(racer.vehicle - vehicleDrop, 0.0, 100.0);
+}
+
+// Team of each catalog driver, looked up once
+static int teamIdOf(int driverId, const Driver &driver)
+{
+    static const vector<int> ids = []
+    {
+        vector<int> v;
+        for (auto *d : driverCatalog())
+            v.push_back(findTeam(d->team));
+        return v;
+    }();
+    return driverId >= 0 ? ids[driverId] : findTeam(driver.team);
+}
+
+void makeField(pmr::vector<Racer> &field, const Driver &playerDrv, const string &playerName)
+{
+    auto &catalog = driverCatalog();
+    field.clear();
+    field.reserve(catalog.size() + 1);
+
+    // Create player
+
+    Racer player;
+    player.driverId = findDriver(playerDrv.name);
+    player.driver = (player.driverId >= 0) ? catalog[player.driverId] : &playerDrv;
+    player.displayName = playerName.c_str();
+    player.teamId = teamIdOf(player.driverId, *player.driver);
+    player.skill = driverSkillIndex(*player.driver);
+    field.push_back(player);
+
+    // Create AI opponents from all teams
+
+    for (int driverId = 0; driverId < (int)catalog.size(); ++driverId)
+    {
+        const Driver &driver = *catalog[driverId];
+        if (driver.name != playerName)
+        {
+            Racer ai;
+            ai.displayName = driver.name.c_str();
+            ai.driver = &driver;
+            ai.driverId = driverId;
+            ai.teamId = teamIdOf(driverId, driver);
+            ai.skill = driverSkillIndex(driver);
+            field.push_back(ai);
+        }
+    }
+}
+
+// ---------- Car Setup ----------
+
+// Twisty, technical tracks want downforce and short gears
+static double idealDownforce(const Track &track)
+{
+    return clampVal(0.5 * (track.difficulty - 5) / 4.0 + 0.5 * (track.corners - 11) / 6.0, 0.0, 1.0);
+}
+
+static double idealGearing(const Track &track)
+{
+    return clampVal(0.9 - 0.7 * idealDownforce(track), 0.0, 1.0);
+}
+
+CarSetup baselineSetup(const Track &track)
+{
+    // Engineers read the corner count but not the surface
+    CarSetup setup;
+    setup.downforce = clampVal((track.corners - 8) / 10.0, 0.0, 1.0);
+    setup.gearing = 1.0 - setup.downforce;
+    return setup;
+}
+
+SetupEffect evaluateSetup(const Team &team, const Track &track, const CarSetup &setup)
+{
+    double window = 1.4 - 0.08 * (team.performance - 7.0);
+    double dfMiss = setup.downforce - idealDownforce(track);
+    double gearMiss = setup.gearing - idealGearing(track);
+    double softness = 0.5 - setup.tyrePressure;
+
+    SetupEffect effect;
+    effect.paceSeconds = -(team.performance - 8.0) * 0.35;
+    effect.paceSeconds += window * (3.0 * dfMiss * dfMiss + 2.0 * gearMiss * gearMiss + 1.5 * softness * softness);
+    effect.paceSeconds -= 1.2 * softness * track.difficulty / 7.0;
+
+    effect.tyreWearScale = (1.0 + 0.6 * softness) * (1.0 - 0.25 * dfMiss) * (1.0 - 0.03 * (team.performance - 8.0));
+    effect.tyreWearScale = max(effect.tyreWearScale, 0.3);
+    return effect;
+}
+
+void applyCarSetup(Racer &racer, const Track &track, const CarSetup &setup)
+{
+    auto team = teams.find(racer.driver->team);
+    if (team == teams.end())
+    {
+        racer.carPace = 0.0;
+        racer.tyreWearScale = 1.0;
+        return;
+    }
+    SetupEffect effect = evaluateSetup(team->second, track, setup);
+    racer.carPace = effect.paceSeconds;
+    racer.tyreWearScale = effect.tyreWearScale;
+}
+
+void recomputePositions(pmr::vector<Racer> &field)
+{
+    pmr::vector<int> idx(field.get_allocator());
+    recomputePositions(field, idx);
+}
+
+void recomputePositions(pmr::vector<Racer> &field, pmr::vector<int> &order)
+{
+    if (order.size() != field.size())
+    {
+        order.resize(field.size());
+        iota(order.begin(), order.end(), 0);
+    }
+    sort(order.begin(), order.end(), [&](int a, int b)
+         { return field[a].cumulativeTime < field[b].cumulativeTime; });
+
+    for (int i = 0; i < (int)order.size(); ++i)
+    {
+        field[order[i]].currentPos = i + 1;
+        field[order[i]].gapAhead = (i == 0) ? 1e9 : field[order[i]].cumulativeTime - field[order[i - 1]].cumulativeTime;
+    }
+}
+
+int aiChooseStrategy(const Racer &r, mt19937 &gen)
+{
+    return aiChooseStrategy(r, r.tyre < 35.0 ? 0.0 : canonicalDraw(gen));
+}
+
+int aiChooseStrategy(const Racer &r, double draw)
+{
+    if (r.tyre < 35.0)
+        return 2;
+    double skill = r.skill;
+    double pushChance = 0.25 + (skill - 7.0) * 0.08;
+    return (draw < pushChance) ? 1 : 0;
+}
+
+// ---------- Race Arena ----------
+
+RaceArena::RaceArena(size_t bytes)
+    : block(bytes), pool(block.data(), block.size(), pmr::new_delete_resource())
+{
+}
+
+// ---------- Race History ----------
+
+void CarHistory::recordLap(int lap, double lapTime, double tyre, bool pitted)
+{
+    if (current.laps == 0)
+    {
+        current.firstLap = lap;
+        current.tyreStart = (float)tyre;
+        current.bestLap = lapTime;
+    }
+    current.laps++;
+    current.totalTime += lapTime;
+    current.bestLap = min(current.bestLap, lapTime);
+    current.tyreEnd = (float)tyre;
+
+    // Restart the delta buffer rather than let it grow; a varint is at most 5 bytes
+    if (recentCount == 0 || recentBytes + 5 > kRecentLapBytes)
+    {
+        recentBytes = recentCount = 0;
+        recentFirstLap = lap;
+        lastLapMs = 0;
+    }
+    int32_t ms = (int32_t)llround(lapTime * 1000.0);
+    uint32_t zigzag = ((uint32_t)(ms - lastLapMs) << 1) ^ (uint32_t)((ms - lastLapMs) >> 31);
+    while (zigzag >= 0x80)
+    {
+        recent[recentBytes++] = (uint8_t)(zigzag | 0x80);
+        zigzag >>= 7;
+    }
+    recent[recentBytes++] = (uint8_t)zigzag;
+    recentCount++;
+    lastLapMs = ms;
+
+    if (pitted)
+        closeStint();
+}
+
+void CarHistory::closeStint()
+{
+    if (stintsUsed == kStintSlots)
+    {
+        StintSummary &a = stints[0];
+        const StintSummary &b = stints[1];
+        a.laps += b.laps;
+        a.totalTime += b.totalTime;
+        a.bestLap = min(a.bestLap, b.bestLap);
+        a.tyreEnd = b.tyreEnd;
+        for (int i = 1; i + 1 < kStintSlots; ++i)
+            stints[i] = stints[i + 1];
+        stintsUsed--;
+    }
+    stints[stintsUsed++] = current;
+    current = StintSummary();
+    recentCount = 0;
+}
+
+int CarHistory::recentLaps(double *lapTimes, int maxLaps, int *firstLap) const
+{
+    int skip = max(0, (int)recentCount - maxLaps);
+    int count = 0;
+    int32_t ms = 0;
+    size_t pos = 0;
+    for (int k = 0; k < recentCount; ++k)
+    {
+        uint32_t zigzag = 0;
+        for (int shift = 0;; shift += 7)
+        {
+            uint8_t byte = recent[pos++];
+            zigzag |= (uint32_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                break;
+        }
+        ms += (int32_t)((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+        if (k >= skip)
+            lapTimes[count++] = ms / 1000.0;
+    }
+    if (firstLap)
+        *firstLap = recentFirstLap + skip;
+    return count;
+}
+
+// ---------- Track Conditions ----------
+
+void buildConditions(pmr::vector<LapConditions> &out, const Track &track, int totalLaps, mt19937 &gen)
+{
+    uniform_real_distribution<double> unit(0.0, 1.0);
+    double temp = 24.0 + 16.0 * unit(gen);
+    double tempDrift = (unit(gen) - 0.6) * 0.4; // usually cooling towards the evening
+
+    // About one race in five sees a shower somewhere in the race
+    int rainStart = totalLaps + 1, rainEnd = totalLaps + 1;
+    double rainPeak = 0.0;
+    if (unit(gen) < 0.2)
+    {
+        rainStart = 1 + (int)(unit(gen) * totalLaps);
+        rainEnd = rainStart + 3 + (int)(unit(gen) * totalLaps * 0.4);
+        rainPeak = 0.3 + 0.7 * unit(gen);
+    }
+
+    out.assign(totalLaps + 1, LapConditions());
+    double rubber = 0.0; // laps of rubber laid since the last wash
+    for (int lap = 1; lap <= totalLaps; ++lap)
+    {
+        double rain = 0.0;
+        if (lap >= rainStart && lap < rainEnd)
+        {
+            // Ramp up and down over two laps at each end
+            double edge = min(lap - rainStart + 1, rainEnd - lap) / 2.0;
+            rain = rainPeak * min(edge, 1.0);
+        }
+        rubber = rain > 0.2 ? 0.0 : rubber + 1.0;
+        temp = clampVal(temp + tempDrift - 3.0 * rain, 10.0, 55.0);
+
+        double grip = -0.5 * track.difficulty / 7.0 * (1.0 - exp(-rubber / 8.0));
+        double tempLoss = 0.002 * (temp - 35.0) * (temp - 35.0);
+
+        LapConditions &c = out[lap];
+        c.paceSeconds = (float)(grip + tempLoss + 9.0 * rain);
+        c.wearScale = (float)((1.0 + 0.015 * (temp - 30.0)) * (1.0 - 0.4 * rain));
+        c.trackTempC = (uint8_t)lround(temp);
+        c.rain = (uint8_t)lround(100.0 * rain);
+    }
+}
+
+// ---------- Race State ----------
+
+void startRace(RaceState &race, const Driver &playerDriver, const string &playerName, const Track &track, int totalLaps,
+               mt19937 &gen)
+{
+    makeField(race.field, playerDriver, playerName);
+    race.order.clear();
+    race.track = &track;
+    race.trackId = -1;
+    auto &trackList = trackCatalog();
+    for (int i = 0; i < (int)trackList.size(); ++i)
+    {
+        if (trackList[i] == &track)
+            race.trackId = i;
+    }
+    race.playerIndex = 0;
+    race.totalLaps = totalLaps;
+    race.lap = 0;
+    race.playerMode = -1;
+    race.fastestLapTime = 1e9;
+    race.fastestLapIndex = -1;
+    buildConditions(race.conditions, track, totalLaps, gen);
+    race.history.assign(race.keepHistory ? race.field.size() : 0, CarHistory());
+    race.pitQueue.clear();
+    race.boxFree.assign(teams.size(), PitHold());
+    race.laneClear = PitHold();
+
+    // Starting positions
+
+    CarSetup setup = baselineSetup(track);
+    for (int i = 0; i < (int)race.field.size(); ++i)
+    {
+        applyCarSetup(race.field[i], track, setup);
+        race.field[i].cumulativeTime = i * 3.0;
+        race.field[i].startingPos = i + 1;
+    }
+    recomputePositions(race.field, race.order);
+}
+
+void applyGrid(RaceState &race, const int *driverIds, int count)
+{
+    pmr::vector<Racer> &field = race.field;
+    for (auto &r : field)
+        r.startingPos = 0; // unplaced
+
+    int slot = 0;
+    for (int k = 0; k < count; ++k)
+    {
+        for (auto &r : field)
+        {
+            if (r.driverId == driverIds[k] && r.startingPos == 0)
+            {
+                r.startingPos = ++slot;
+                break;
+            }
+        }
+    }
+    for (auto &r : field)
+    {
+        if (r.startingPos == 0)
+            r.startingPos = ++slot;
+    }
+
+    for (auto &r : field)
+        r.cumulativeTime = (r.startingPos - 1) * 3.0;
+    recomputePositions(field, race.order);
+}
+
+bool isDecisionLap(int lap)
+{
+    return lap % 3 == 1; // Every 3 laps: 1, 4, 7, 10, 13, 16, 19, 22
+}
+
+// ---------- Common Random Numbers ----------
+
+static uint64_t mix64(uint64_t x)
+{
+    // splitmix64 finaliser so neighbouring inputs give unrelated outputs
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// Which of a car's draws in a lap; each is used at most once per lap
+enum
+{
+    kDrawJitter,
+    kDrawWear,
+    kDrawChoice,
+    kDrawOvertake
+};
+
+// Stateless, so a draw a strategy never makes cannot shift any other draw
+static double commonDraw(const RaceState &race, const Racer &car, int slot)
+{
+    uint64_t key = mix64(race.drawSeed) + (uint64_t)car.driverId * 0x100000001B3ull + (uint64_t)race.lap * 8 + slot;
+    double u = (double)(mix64(key) >> 11) * 0x1.0p-53;
+    return race.antithetic ? 1.0 - u : u;
+}
+
+// ---------- Lap Simulation ----------
+
+// Min-heap order for the pit queue
+static bool arrivesLater(const PitEvent &a, const PitEvent &b)
+{
+    return a.arrival > b.arrival || (a.arrival == b.arrival && a.car > b.car);
+}
+
+void simulateLap(RaceState &race, int playerAction, mt19937 &gen)
+{
+    pmr::vector<Racer> &field = race.field;
+    int playerIndex = race.playerIndex;
+    ++race.lap;
+    const LapConditions &conditions = race.lap < (int)race.conditions.size() ? race.conditions[race.lap] : kDryConditions;
+
+    if (playerAction == 1)
+        race.playerMode = 1;
+    else if (playerAction == 2)
+        race.playerMode = 0;
+
+    perfBegin(race.perf, kPhaseCarLoop);
+    for (int i = 0; i < (int)field.size(); ++i)
+    {
+        bool willPit = (i == playerIndex && playerAction == 3);
+
+        int mode;
+        if (i == playerIndex)
+            mode = race.playerMode;
+        else if (race.policy)
+            mode = race.policy->decide(race.trackId, field[i], race.lap, race.totalLaps, willPit);
+        else if (race.commonDraws)
+            mode = aiChooseStrategy(field[i], commonDraw(race, field[i], kDrawChoice));
+        else
+            mode = aiChooseStrategy(field[i], gen);
+        if (i != playerIndex && field[i].tyre < 30.0)
+            willPit = true;
+
+        double lapTime = race.commonDraws
+                             ? computeLapTimeSeconds(field[i], *race.track, mode,
+                                                     commonDraw(race, field[i], kDrawJitter), conditions)
+                             : computeLapTimeSeconds(field[i], *race.track, mode, i == playerIndex, gen, conditions);
+
+        if (willPit)
+        {
+            race.pitQueue.push_back({field[i].cumulativeTime + lapTime, i});
+            push_heap(race.pitQueue.begin(), race.pitQueue.end(), arrivesLater);
+            lapTime += race.track->pitStopTime;
+            field[i].pitStops++;
+            field[i].inPitThisLap = true;
+        }
+        else
+        {
+            field[i].inPitThisLap = false;
+        }
+
+        field[i].lastLapTime = lapTime;
+        if (!race.history.empty())
+            race.history[i].recordLap(race.lap, lapTime, field[i].tyre, willPit);
+        if (race.commonDraws)
+            applyWearAndDamage(field[i], mode, willPit, commonDraw(race, field[i], kDrawWear), conditions);
+        else
+            applyWearAndDamage(field[i], mode, willPit, gen, conditions);
+    }
+    perfEnd(race.perf, kPhaseCarLoop);
+
+    perfBegin(race.perf, kPhaseInteractions);
+    resolvePitStops(race);
+    resolveInteractions(race, gen);
+    perfEnd(race.perf, kPhaseInteractions);
+
+    perfBegin(race.perf, kPhasePositions);
+    recomputePositions(field, race.order);
+    perfEnd(race.perf, kPhasePositions);
+}
+
+// ---------- Pit Stops ----------
+
+double pitLaneSeconds(const Track &track)
+{
+    return max(track.pitStopTime - kPitStationarySeconds, 0.0);
+}
+
+// What a hold still asks of a car entering at arrival
+static double heldUntil(const PitHold &hold, double arrival)
+{
+    return hold.arrival <= arrival ? hold.until : 0.0;
+}
+
+// A car entering before the current holder only extends the hold, so cars
+// entering after both still wait for whichever leaves last
+static void takeHold(PitHold &hold, double until, double arrival)
+{
+    if (arrival >= hold.arrival)
+        hold = {until, arrival};
+    else
+        hold.until = max(hold.until, until);
+}
+
+void resolvePitStops(RaceState &race)
+{
+    pmr::vector<PitEvent> &queue = race.pitQueue;
+    double lane = pitLaneSeconds(*race.track);
+    double toBox = lane * kPitEntryShare;
+
+    while (!queue.empty())
+    {
+        pop_heap(queue.begin(), queue.end(), arrivesLater);
+        PitEvent stop = queue.back();
+        queue.pop_back();
+        Racer &car = race.field[stop.car];
+
+        // Stacked behind the teammate while the box is busy
+        bool hasBox = car.teamId >= 0 && car.teamId < (int)race.boxFree.size();
+        double atBox = stop.arrival + toBox;
+        double served = hasBox ? max(atBox, heldUntil(race.boxFree[car.teamId], stop.arrival)) : atBox;
+
+        // Cars go out in the order they came in, each with a clear lane behind
+        // the last; one held for a clear lane still occupies its box
+        double ready = served + kPitStationarySeconds;
+        double released = max(ready, heldUntil(race.laneClear, stop.arrival));
+        takeHold(race.laneClear, released + kPitReleaseGap, stop.arrival);
+        if (hasBox)
+            takeHold(race.boxFree[car.teamId], released, stop.arrival);
+
+        double wait = released - (atBox + kPitStationarySeconds);
+        if (wait > 0.0)
+            car.lastLapTime += wait;
+    }
+}
+
+// ---------- Car Interactions ----------
+
+// Fewer corners means longer straights: more to gain from DRS, less time
+// spent losing downforce in someone's wake.
+double drsGainSeconds(const Track &track)
+{
+    return max(0.1, 0.3 + 0.02 * (18 - track.corners));
+}
+
+double dirtyAirLossSeconds(const Track &track)
+{
+    return 0.1 + 0.015 * track.corners;
+}
+
+void resolveInteractions(RaceState &race, mt19937 &gen)
+{
+    pmr::vector<Racer> &field = race.field;
+    const Track &track = *race.track;
+    bool drsEnabled = race.lap >= kDrsEnabledLap;
+
+    // Walk the start-of-lap order front to back; the car ahead is already final
+    for (int k = 0; k < (int)race.order.size(); ++k)
+    {
+        int i = race.order[k];
+        Racer &car = field[i];
+
+        if (k > 0 && !car.inPitThisLap)
+        {
+            const Racer &ahead = field[race.order[k - 1]];
+            double gap = car.gapAhead;
+
+            if (gap < kDirtyAirWindow)
+                car.lastLapTime += dirtyAirLossSeconds(track) * (1.0 - gap / kDirtyAirWindow);
+            if (drsEnabled && gap < kDrsWindow)
+                car.lastLapTime -= drsGainSeconds(track);
+
+            // Quicker through the lap than the car in front: pass or get held up
+            double finish = car.cumulativeTime + car.lastLapTime;
+            if (!ahead.inPitThisLap && finish < ahead.cumulativeTime)
+            {
+                double attack = car.driver->overtaking + 0.5 * car.driver->aggression;
+                double defence = ahead.driver->cornering + 0.5 * ahead.driver->aggression;
+                double margin = ahead.cumulativeTime - finish;
+                double chance = clampVal(0.5 + (attack - defence) * 0.06 + margin * 0.25 - track.difficulty * 0.03, 0.05, 0.95);
+                double roll = race.commonDraws ? commonDraw(race, car, kDrawOvertake)
+                                               : uniform_real_distribution<double>(0.0, 1.0)(gen);
+                if (roll >= chance)
+                    car.lastLapTime = ahead.cumulativeTime + kHeldGap - car.cumulativeTime;
+            }
+        }
+
+        car.cumulativeTime += car.lastLapTime;
+
+        if (car.lastLapTime < car.fastestLap)
+            car.fastestLap = car.lastLapTime;
+        if (car.lastLapTime < race.fastestLapTime)
+        {
+            race.fastestLapTime = car.lastLapTime;
+            race.fastestLapIndex = i;
+        }
+    }
+}
+
+// ---------- Headless Simulation ----------
+
+int fieldSize()
+{
+    return (int)driverCatalog().size();
+}
+
+int strategyAction(string_view strategy, int lap)
+{
+    if (!isDecisionLap(lap))
+        return -1;
+    size_t slot = (size_t)(lap / 3);
+    if (slot >= strategy.size())
+        return -1;
+
+    switch (strategy[slot])
+    {
+    case 'P':
+    case 'p':
+        return 1;
+    case 'S':
+    case 's':
+        return 2;
+    case 'B':
+    case 'b':
+        return 3;
+    default:
+        return -1;
+    }
+}
+
+uint32_t mixSeed(uint64_t seed)
+{
+    seed = mix64(seed);
+    return (uint32_t)(seed ^ (seed >> 32));
+}
+
+bool simulateRace(const RaceScenario &scenario, uint64_t seed, RaceState &race)
+{
+    auto &trackList = trackCatalog();
+    auto &driverList = driverCatalog();
+    if (scenario.track < 0 || scenario.track >= (int)trackList.size())
+        return false;
+    if (scenario.playerDriver < 0 || scenario.playerDriver >= (int)driverList.size())
+        return false;
+    if (scenario.totalLaps <= 0)
+        return false;
+    if (scenario.policy && !scenario.policy->sized())
+        return false;
+
+    mt19937 gen(mixSeed(seed));
+    const Driver &player = *driverList[scenario.playerDriver];
+
+    startRace(race, player, player.name, *trackList[scenario.track], scenario.totalLaps, gen);
+    race.policy = scenario.policy;
+    race.commonDraws = scenario.commonDraws;
+    race.antithetic = scenario.antithetic;
+    race.drawSeed = seed;
+    if (scenario.setup)
+        applyCarSetup(race.field[race.playerIndex], *race.track, *scenario.setup);
+    if (scenario.gridSize > 0)
+        applyGrid(race, scenario.grid, scenario.gridSize);
+    for (int lap = 1; lap <= race.totalLaps; ++lap)
+        simulateLap(race, strategyAction(scenario.strategy, lap), gen);
+    return true;
+}
+
+void summariseRace(const RaceState &race, RaceResult &out, int *finishOrder)
+{
+    const Racer &p = race.field[race.playerIndex];
+    out.playerPosition = p.currentPos;
+    out.playerPitStops = p.pitStops;
+    out.playerTime = p.cumulativeTime;
+    out.fastestLap = race.fastestLapTime;
+    out.fastestLapDriver = race.fastestLapIndex >= 0 ? race.field[race.fastestLapIndex].driverId : -1;
+
+    for (auto &r : race.field)
+    {
+        if (r.currentPos == 1)
+            out.winnerDriver = r.driverId;
+        if (finishOrder)
+            finishOrder[r.currentPos - 1] = r.driverId;
+    }
+}
+
+bool simulateRace(const RaceScenario &scenario, uint64_t seed, RaceResult &out, int *finishOrder)
+{
+    // Each worker thread reuses one arena for every race it runs
+    static thread_local RaceArena arena;
+
+    bool ok;
+    {
+        RaceState race(arena.resource());
+        ok = simulateRace(scenario, seed, race);
+        if (ok)
+            summariseRace(race, out, finishOrder);
+    }
+    arena.reset();
+    return ok;
+}
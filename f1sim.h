@@ -0,0 +1,348 @@
+// F1 TERMINAL RACER 2025 - SIMULATION CORE
+// Race model shared by the interactive game and the headless batch engine.
+
+#ifndef F1SIM_H
+#define F1SIM_H
+
+#include <cstdint>
+#include <cstddef>
+#include <map>
+#include <memory_resource>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ---------- Utility & Globals ----------
+
+extern std::mt19937 rng;
+
+std::string formatTime(double seconds);
+// m:ss.mmm written at first without allocating; returns one past the end.
+// Needs at most kTimeChars bytes.
+const int kTimeChars = 24;
+char *formatTimeChars(char *first, double seconds);
+
+template <typename T>
+T clampVal(T v, T lo, T hi) { return v < lo ? lo : (v > hi ? hi : v); }
+
+// ---------- Data Structures ----------
+
+struct Driver
+{
+    std::string name;
+    int speed, cornering, overtaking, consistency, aggression, strategy;
+    std::string team;
+};
+
+struct Track
+{
+    std::string name, country, asciiMap;
+    double baseLapSec;
+    int difficulty, corners;
+    double pitStopTime;
+};
+
+// Racers point at their catalog entry rather than copying names, so a
+// field is plain data that can live in a race arena.
+struct Racer
+{
+    const char *displayName = "";
+    const Driver *driver = nullptr;
+    int driverId = -1;
+    int teamId = -1; // findTeam order; teammates share a pit box
+    double skill = 0.0; // driverSkillIndex, computed once per race
+    double carPace = 0.0, tyreWearScale = 1.0; // from the car setup, see applyCarSetup
+    double cumulativeTime = 0.0, lastLapTime = 0.0, fastestLap = 1e9;
+    double tyre = 100.0, vehicle = 100.0;
+    int startingPos = 0, currentPos = 0, pitStops = 0;
+    double gapAhead = 1e9; // to the car in front, 1e9 for the leader
+    bool inPitThisLap = false;
+};
+
+struct Team
+{
+    std::string name;
+    double performance;
+    std::string carModel;
+    int budget;
+};
+
+// ---------- Game Content ----------
+
+extern std::map<std::string, Team> teams;
+extern std::map<std::string, std::vector<Driver>> teamDrivers;
+extern std::map<std::string, Track> tracks;
+
+// Stable integer ids (map order) used by the batch engine and the C ABI.
+const std::vector<const Track *> &trackCatalog();
+const std::vector<const Driver *> &driverCatalog();
+int findTrack(std::string_view key);
+int findTeam(std::string_view key);
+int findDriver(std::string_view name);
+
+// ---------- Core Logic ----------
+
+const int kDefaultRaceLaps = 25;
+
+// Track state for one lap, precomputed per race so the lap kernel only
+// reads two numbers. See buildConditions.
+struct LapConditions
+{
+    float paceSeconds = 0.0f; // rubber, temperature and rain, added to every car
+    float wearScale = 1.0f;
+    std::uint8_t trackTempC = 30, rain = 0; // rain 0..100, for display
+};
+
+const LapConditions kDryConditions;
+
+double driverSkillIndex(const Driver &d);
+double computeLapTimeSeconds(const Racer &racer, const Track &track, int mode, bool isPlayer, std::mt19937 &gen = rng,
+                             const LapConditions &conditions = kDryConditions);
+void applyWearAndDamage(Racer &racer, int mode, bool hadPitThisLap, std::mt19937 &gen = rng,
+                        const LapConditions &conditions = kDryConditions);
+// Same models with the random draw supplied, uniform in [0, 1). The gen
+// versions draw one and call these, so both give identical results.
+double computeLapTimeSeconds(const Racer &racer, const Track &track, int mode, double draw,
+                             const LapConditions &conditions = kDryConditions);
+void applyWearAndDamage(Racer &racer, int mode, bool hadPitThisLap, double draw,
+                        const LapConditions &conditions = kDryConditions);
+// playerDrv and playerName must outlive the race unless they are catalog entries.
+void makeField(std::pmr::vector<Racer> &field, const Driver &playerDrv, const std::string &playerName);
+void recomputePositions(std::pmr::vector<Racer> &field);
+// order keeps field indices in position order between calls.
+void recomputePositions(std::pmr::vector<Racer> &field, std::pmr::vector<int> &order);
+int aiChooseStrategy(const Racer &r, std::mt19937 &gen = rng);
+int aiChooseStrategy(const Racer &r, double draw);
+
+// ---------- Car Setup ----------
+
+// Each knob runs 0..1. Downforce trades straight-line speed for grip and
+// gentler tyres, gearing should match how twisty the track is, and lower
+// tyre pressures buy pace with wear.
+struct CarSetup
+{
+    double downforce = 0.5, gearing = 0.5, tyrePressure = 0.5;
+};
+
+struct SetupEffect
+{
+    double paceSeconds = 0.0; // added to every lap, negative is faster
+    double tyreWearScale = 1.0;
+};
+
+// What a team engineer would bring without running the numbers.
+CarSetup baselineSetup(const Track &track);
+// Better cars are faster outright and have a wider setup window.
+SetupEffect evaluateSetup(const Team &team, const Track &track, const CarSetup &setup);
+void applyCarSetup(Racer &racer, const Track &track, const CarSetup &setup);
+
+// ---------- Pit Lane ----------
+
+const double kPitStationarySeconds = 2.5; // in the box while the crew works
+const double kPitReleaseGap = 1.0;        // clear lane a car needs behind the last one released
+const double kPitEntryShare = 0.5;        // of the lane time, driven before reaching the box
+
+// Track::pitStopTime is the cost of a stop with nobody in the way: the
+// lane driven at the speed limit plus the stationary time.
+double pitLaneSeconds(const Track &track);
+
+struct PitEvent
+{
+    double arrival = 0.0; // race time at the pit entry
+    int car = -1;
+};
+
+// A box or the lane held until a race time by the car that entered at arrival
+struct PitHold
+{
+    double until = 0.0;
+    double arrival = 0.0;
+};
+
+// ---------- Race State ----------
+
+struct PolicyTable;
+class PerfCounters;
+
+// ---------- Race Arena ----------
+
+// Per-worker monotonic arena for race-scoped containers. reset() hands the
+// same block back, so once warm a batch worker never touches the global
+// allocator or contends with other threads for it.
+class RaceArena
+{
+public:
+    explicit RaceArena(std::size_t bytes = 64 * 1024);
+    RaceArena(const RaceArena &) = delete;
+    RaceArena &operator=(const RaceArena &) = delete;
+
+    std::pmr::memory_resource *resource() { return &pool; }
+    void reset() { pool.release(); }
+
+private:
+    std::vector<std::byte> block;
+    std::pmr::monotonic_buffer_resource pool;
+};
+
+// ---------- Race History ----------
+
+struct StintSummary
+{
+    int firstLap = 0, laps = 0;
+    double totalTime = 0.0, bestLap = 0.0;
+    float tyreStart = 100.0f, tyreEnd = 100.0f;
+
+    double averageLap() const { return laps ? totalTime / laps : 0.0; }
+};
+
+const int kStintSlots = 16;
+const int kRecentLapBytes = 96;
+
+// Fixed-size lap history for one car, however long the race. The current
+// stint's lap times are kept as zigzag varint deltas in milliseconds
+// (usually two bytes a lap; the buffer restarts when full). A pit stop
+// rolls the stint into a summary, and once every slot is used the two
+// oldest summaries merge, so early stints get coarser instead of growing.
+class CarHistory
+{
+public:
+    // lapTime is the car's own pace before traffic; tyre is the wear at the
+    // start of the lap. A pit ends the stint.
+    void recordLap(int lap, double lapTime, double tyre, bool pitted);
+
+    int stintCount() const { return stintsUsed; }
+    const StintSummary &stint(int i) const { return stints[i]; }
+    const StintSummary &currentStint() const { return current; }
+
+    // Most recent laps of the current stint, oldest first; returns the count.
+    int recentLaps(double *lapTimes, int maxLaps, int *firstLap = nullptr) const;
+
+private:
+    void closeStint();
+
+    StintSummary stints[kStintSlots];
+    StintSummary current;
+    int stintsUsed = 0;
+    std::uint8_t recent[kRecentLapBytes];
+    std::uint16_t recentBytes = 0, recentCount = 0;
+    int recentFirstLap = 0;
+    std::int32_t lastLapMs = 0;
+};
+
+// Everything a race needs between laps; the interactive and headless flows
+// both advance it with simulateLap. Containers allocate from arena.
+struct RaceState
+{
+    explicit RaceState(std::pmr::memory_resource *arena = std::pmr::get_default_resource())
+        : field(arena), order(arena), conditions(arena), history(arena), pitQueue(arena), boxFree(arena) {}
+
+    std::pmr::vector<Racer> field;
+    std::pmr::vector<int> order;
+    std::pmr::vector<LapConditions> conditions; // indexed by lap, 1..totalLaps
+    std::pmr::vector<CarHistory> history;       // one per car when keepHistory is set
+    bool keepHistory = false;
+    std::pmr::vector<PitEvent> pitQueue; // this lap's stops, a min-heap on arrival
+    std::pmr::vector<PitHold> boxFree;   // per team, until its box is next free
+    PitHold laneClear;                   // until the next car may be released
+    const Track *track = nullptr;
+    int trackId = -1;
+    const PolicyTable *policy = nullptr; // AI uses table lookups when set
+    int playerIndex = 0;
+    int totalLaps = kDefaultRaceLaps;
+    int lap = 0;
+    int playerMode = -1;
+    double fastestLapTime = 1e9;
+    int fastestLapIndex = -1;
+
+    // Common random numbers: every draw in a lap is hashed from drawSeed,
+    // the car and the lap instead of taken from gen, so races sharing a
+    // drawSeed see the same luck whatever strategy is run. antithetic
+    // mirrors each draw (u -> 1 - u).
+    bool commonDraws = false, antithetic = false;
+    std::uint64_t drawSeed = 0;
+
+    PerfCounters *perf = nullptr; // phase counters for simulateLap, see f1perf.h
+};
+
+// Rubbering-in over the race, a drifting track temperature and, on some
+// days, a rain shower that washes the rubber away.
+void buildConditions(std::pmr::vector<LapConditions> &out, const Track &track, int totalLaps, std::mt19937 &gen = rng);
+
+void startRace(RaceState &race, const Driver &playerDriver, const std::string &playerName, const Track &track, int totalLaps,
+               std::mt19937 &gen = rng);
+// Lines the listed drivers up first, in order; everyone else keeps their
+// relative order behind them. Call before the first lap.
+void applyGrid(RaceState &race, const int *driverIds, int count);
+bool isDecisionLap(int lap);
+
+// ---------- Pit Stops ----------
+
+// Drains the lap's pit stops in arrival order. A car finding its teammate
+// still in the box waits for it, and no car is released until the lane is
+// clear of the last one sent out. The wait goes on top of pitStopTime.
+// Holds carry over between laps but only bind cars that entered after the
+// car holding them: a lapped car's stop is drained a lap before a leader's
+// stop that comes earlier in race time, and must not queue the leader.
+// O(stops log stops) a lap, whatever the size of the field.
+void resolvePitStops(RaceState &race);
+
+// ---------- Car Interactions ----------
+
+const double kDrsWindow = 1.0;      // gap to the car ahead that opens DRS
+const double kDirtyAirWindow = 1.5; // gap inside which the wake costs time
+const double kHeldGap = 0.2;        // margin behind a car that held position
+const int kDrsEnabledLap = 3;
+
+double drsGainSeconds(const Track &track);
+double dirtyAirLossSeconds(const Track &track);
+
+// Applies DRS, dirty air and overtake-or-hold between neighbours in
+// start-of-lap order, then banks each car's lap. O(field size).
+void resolveInteractions(RaceState &race, std::mt19937 &gen = rng);
+
+// playerAction: 1 = PUSH, 2 = SAVE, 3 = PIT, -1 = keep current mode.
+void simulateLap(RaceState &race, int playerAction, std::mt19937 &gen = rng);
+
+// ---------- Headless Simulation ----------
+
+// One character per decision lap: 'P' push, 'S' save, 'B' box.
+// Decision laps past the end of the script keep the current mode.
+struct RaceScenario
+{
+    int track = 0;
+    int playerDriver = 0;
+    int totalLaps = kDefaultRaceLaps;
+    std::string_view strategy;
+    const PolicyTable *policy = nullptr;
+    const CarSetup *setup = nullptr; // player car, baselineSetup when null
+    const int *grid = nullptr;       // driver ids for the front of the grid, see applyGrid
+    int gridSize = 0;
+    bool commonDraws = false;        // lap draws keyed on the seed, see RaceState
+    bool antithetic = false;
+};
+
+struct RaceResult
+{
+    int playerPosition = 0;
+    int playerPitStops = 0;
+    int winnerDriver = -1;
+    int fastestLapDriver = -1;
+    double playerTime = 0.0;
+    double fastestLap = 0.0;
+};
+
+int fieldSize();
+int strategyAction(std::string_view strategy, int lap);
+std::uint32_t mixSeed(std::uint64_t seed);
+
+// Runs the whole race and leaves the final state in race. False, with
+// nothing run, for an unknown track or driver, no laps, or a policy table
+// whose cells do not match its dimensions.
+bool simulateRace(const RaceScenario &scenario, std::uint64_t seed, RaceState &race);
+
+// finishOrder, when given, receives fieldSize() driver ids in finishing order.
+void summariseRace(const RaceState &race, RaceResult &out, int *finishOrder = nullptr);
+bool simulateRace(const RaceScenario &scenario, std::uint64_t seed, RaceResult &out, int *finishOrder = nullptr);
+
+#endif
@@ -0,0 +1,181 @@
+// F1 TERMINAL RACER 2025 - C ABI
+
+#include "f1sim_c.h"
+
+#include "f1batch.h"
+#include "f1policy.h"
+
+#include <algorithm>
+#include <atomic>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+static_assert(is_standard_layout<f1_result>::value, "f1_result must stay a plain C struct");
+static_assert(sizeof(int32_t) == sizeof(int), "finish orders are written in place as int");
+
+// ---------- Catalog ----------
+
+int32_t f1_abi_version(void)
+{
+    return F1SIM_ABI_VERSION;
+}
+
+int32_t f1_track_count(void)
+{
+    return (int32_t)trackCatalog().size();
+}
+
+const char *f1_track_name(int32_t track)
+{
+    auto &catalog = trackCatalog();
+    if (track < 0 || track >= (int32_t)catalog.size())
+        return nullptr;
+    return catalog[track]->name.c_str();
+}
+
+int32_t f1_driver_count(void)
+{
+    return (int32_t)driverCatalog().size();
+}
+
+const char *f1_driver_name(int32_t driver)
+{
+    auto &catalog = driverCatalog();
+    if (driver < 0 || driver >= (int32_t)catalog.size())
+        return nullptr;
+    return catalog[driver]->name.c_str();
+}
+
+int32_t f1_field_size(void)
+{
+    return fieldSize();
+}
+
+// ---------- Policy ----------
+
+static PolicyTable loadedPolicy;
+
+int32_t f1_load_policy(const char *path)
+{
+    if (!path)
+    {
+        loadedPolicy = PolicyTable();
+        return F1SIM_OK;
+    }
+    PolicyTable table;
+    if (!loadPolicyTable(table, path))
+        return F1SIM_ERR_ARGUMENT;
+    loadedPolicy = move(table);
+    return F1SIM_OK;
+}
+
+static const PolicyTable *activePolicy()
+{
+    return loadedPolicy.empty() ? nullptr : &loadedPolicy;
+}
+
+// ---------- Batch Simulation ----------
+
+int32_t f1_simulate_batch(const f1_scenario *scenarios, const uint64_t *seeds, size_t count,
+                          f1_result *results, int32_t *finish_orders, int32_t threads)
+{
+    if (count == 0)
+        return F1SIM_OK;
+    if (!scenarios || !seeds || !results)
+        return F1SIM_ERR_ARGUMENT;
+
+    // Each race reads its scenario and writes its result slot in place
+    int stride = fieldSize();
+    atomic<size_t> failed{0};
+
+    parallelFor(count, threads, [&](size_t begin, size_t end)
+                {
+        size_t localFailed = 0;
+        for (size_t i = begin; i < end; ++i)
+        {
+            RaceScenario scenario;
+            scenario.track = scenarios[i].track;
+            scenario.playerDriver = scenarios[i].player_driver;
+            scenario.totalLaps = scenarios[i].total_laps > 0 ? scenarios[i].total_laps : kDefaultRaceLaps;
+            if (scenarios[i].strategy)
+                scenario.strategy = string_view(scenarios[i].strategy);
+            scenario.policy = activePolicy();
+
+            RaceResult r;
+            int *order = finish_orders ? (int *)finish_orders + i * stride : nullptr;
+            if (!simulateRace(scenario, seeds[i], r, order))
+            {
+                // An invalid race leaves a zeroed row, finish order included
+                results[i] = f1_result();
+                if (order)
+                    fill(order, order + stride, 0);
+                ++localFailed;
+                continue;
+            }
+
+            results[i].player_position = r.playerPosition;
+            results[i].player_pit_stops = r.playerPitStops;
+            results[i].winner_driver = r.winnerDriver;
+            results[i].fastest_lap_driver = r.fastestLapDriver;
+            results[i].player_time = r.playerTime;
+            results[i].fastest_lap = r.fastestLap;
+        }
+        failed += localFailed; });
+
+    return failed ? F1SIM_ERR_SCENARIO : F1SIM_OK;
+}
+
+// ---------- Adaptive Comparison ----------
+
+int32_t f1_compare_adaptive(const f1_scenario *base, const char *const *strategies, size_t count,
+                            const f1_adaptive_options *options, f1_estimate *estimates, int32_t *leader)
+{
+    if (!base || !strategies || !estimates || count == 0)
+        return F1SIM_ERR_ARGUMENT;
+
+    RaceScenario scenario;
+    scenario.track = base->track;
+    scenario.playerDriver = base->player_driver;
+    scenario.totalLaps = base->total_laps > 0 ? base->total_laps : kDefaultRaceLaps;
+    scenario.policy = activePolicy();
+    RaceResult probe;
+    if (!simulateRace(scenario, 0, probe))
+        return F1SIM_ERR_SCENARIO;
+
+    vector<string_view> plans(count);
+    for (size_t i = 0; i < count; ++i)
+        plans[i] = strategies[i] ? string_view(strategies[i]) : string_view();
+
+    AdaptiveOptions opts;
+    if (options)
+    {
+        opts.metric = options->metric == F1SIM_METRIC_WIN ? AdaptiveMetric::WinProbability : AdaptiveMetric::FinishPosition;
+        if (options->precision > 0.0)
+            opts.precision = options->precision;
+        if (options->confidence > 0.0)
+            opts.confidence = options->confidence;
+        if (options->wave_size > 0)
+            opts.waveSize = options->wave_size;
+        if (options->max_races > 0)
+            opts.maxRaces = options->max_races;
+        opts.threads = options->threads;
+        opts.seedBase = options->seed;
+    }
+
+    AdaptiveReport report = compareStrategiesAdaptive(scenario, plans, opts);
+    if (report.scenarioError)
+        return F1SIM_ERR_SCENARIO;
+    for (size_t i = 0; i < count; ++i)
+    {
+        estimates[i].mean = report.estimates[i].stat.mean;
+        estimates[i].half_width = report.estimates[i].halfWidth;
+        estimates[i].races = report.estimates[i].stat.n;
+        estimates[i].dominated = report.estimates[i].dominated ? 1 : 0;
+    }
+    if (leader)
+        *leader = report.leader;
+    return F1SIM_OK;
+}
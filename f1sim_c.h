@@ -0,0 +1,106 @@
+/* F1 TERMINAL RACER 2025 - C ABI
+ * Stable entry points for embedding the simulator through FFI.
+ * Tracks and drivers are addressed by catalog index (see f1_track_name /
+ * f1_driver_name). All buffers are owned by the caller; nothing is copied. */
+
+#ifndef F1SIM_C_H
+#define F1SIM_C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(F1SIM_BUILD_SHARED)
+#define F1SIM_API __declspec(dllexport)
+#elif defined(_WIN32) && defined(F1SIM_USE_SHARED)
+#define F1SIM_API __declspec(dllimport)
+#elif defined(__GNUC__)
+#define F1SIM_API __attribute__((visibility("default")))
+#else
+#define F1SIM_API
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define F1SIM_ABI_VERSION 1
+
+#define F1SIM_OK 0
+#define F1SIM_ERR_ARGUMENT -1
+#define F1SIM_ERR_SCENARIO -2
+
+typedef struct f1_scenario
+{
+    int32_t track;         /* index into the track catalog */
+    int32_t player_driver; /* index into the driver catalog */
+    int32_t total_laps;    /* 0 selects the default race length */
+    const char *strategy;  /* 'P'ush / 'S'ave / 'B'ox per decision lap, may be NULL */
+} f1_scenario;
+
+typedef struct f1_result
+{
+    int32_t player_position;
+    int32_t player_pit_stops;
+    int32_t winner_driver;
+    int32_t fastest_lap_driver;
+    double player_time;
+    double fastest_lap;
+} f1_result;
+
+F1SIM_API int32_t f1_abi_version(void);
+
+F1SIM_API int32_t f1_track_count(void);
+F1SIM_API const char *f1_track_name(int32_t track);
+F1SIM_API int32_t f1_driver_count(void);
+F1SIM_API const char *f1_driver_name(int32_t driver);
+F1SIM_API int32_t f1_field_size(void);
+
+/* Loads an AI policy table built by `f1batch policy-build`; AI cars in later
+ * batch calls use table lookups. NULL clears it. Not thread-safe against
+ * batches already running. */
+F1SIM_API int32_t f1_load_policy(const char *path);
+
+/* Runs count races: scenarios[i] with seeds[i] into results[i].
+ * finish_orders may be NULL, otherwise it holds count * f1_field_size()
+ * driver indices. threads <= 0 uses every core. Races whose scenario is
+ * invalid are zeroed and reported through F1SIM_ERR_SCENARIO. */
+F1SIM_API int32_t f1_simulate_batch(const f1_scenario *scenarios, const uint64_t *seeds, size_t count,
+                                    f1_result *results, int32_t *finish_orders, int32_t threads);
+
+/* Adaptive comparison: races the strategies in waves until every confidence
+ * interval is within precision or the leader is statistically separated.
+ * Dominated strategies stop receiving races. estimates holds count entries;
+ * leader receives the index of the best strategy. Zeroed option fields take
+ * their defaults. */
+
+#define F1SIM_METRIC_POSITION 0
+#define F1SIM_METRIC_WIN 1
+
+typedef struct f1_adaptive_options
+{
+    int32_t metric;     /* F1SIM_METRIC_POSITION or F1SIM_METRIC_WIN */
+    double precision;   /* confidence-interval half-width target */
+    double confidence;  /* e.g. 0.95 */
+    int32_t wave_size;  /* races per wave */
+    int64_t max_races;  /* total budget */
+    int32_t threads;
+    uint64_t seed;
+} f1_adaptive_options;
+
+typedef struct f1_estimate
+{
+    double mean;
+    double half_width;
+    int64_t races;
+    int32_t dominated;
+} f1_estimate;
+
+F1SIM_API int32_t f1_compare_adaptive(const f1_scenario *base, const char *const *strategies, size_t count,
+                                      const f1_adaptive_options *options, f1_estimate *estimates, int32_t *leader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,496 @@
+// F1 TERMINAL RACER 2025 - RESULTS STORE
+
+#include "f1store.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+static const char kLogMagic[4] = {'F', '1', 'R', 'L'};
+static const char kIndexMagic[4] = {'F', '1', 'R', 'X'};
+static const uint32_t kStoreVersion = 1;
+static const size_t kLogHeaderSize = 8;
+static const size_t kIndexHeaderSize = 12;
+static const size_t kRaceFixedBytes = 20;
+static const size_t kCarBytes = 6;
+static const size_t kWriteBufferBytes = 1 << 20;
+
+// ---------- Encoding ----------
+
+// Records are little-endian regardless of host
+static void put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put32(uint8_t *p, uint32_t v)
+{
+    for (int i = 0; i < 4; ++i)
+        p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static void put64(uint8_t *p, uint64_t v)
+{
+    for (int i = 0; i < 8; ++i)
+        p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static void putFloat(uint8_t *p, float f)
+{
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    put32(p, bits);
+}
+
+static uint16_t get16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; --i)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+static uint64_t get64(const uint8_t *p)
+{
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+static float getFloat(const uint8_t *p)
+{
+    uint32_t bits = get32(p);
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+static uint32_t checksum(const uint8_t *data, size_t size)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < size; ++i)
+        h = (h ^ data[i]) * 16777619u;
+    return h;
+}
+
+static bool seekTo(FILE *f, uint64_t offset)
+{
+#ifdef _WIN32
+    return _fseeki64(f, (long long)offset, SEEK_SET) == 0;
+#else
+    return fseeko(f, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+// ---------- Records ----------
+
+void storedRaceFrom(const RaceState &race, int source, uint64_t seed, StoredRace &out)
+{
+    out.seed = seed;
+    out.track = race.trackId;
+    out.playerDriver = race.field[race.playerIndex].driverId;
+    out.source = source;
+    out.totalLaps = race.lap;
+    out.fastestLap = race.fastestLapTime;
+    out.fastestLapDriver = race.fastestLapIndex >= 0 ? race.field[race.fastestLapIndex].driverId : -1;
+
+    out.classification.resize(race.field.size());
+    for (auto &r : race.field)
+    {
+        StoredCar &car = out.classification[r.currentPos - 1];
+        car.driver = r.driverId;
+        car.pitStops = r.pitStops;
+        car.totalTime = r.cumulativeTime;
+    }
+}
+
+// ---------- Results Store ----------
+
+ResultsStore::~ResultsStore()
+{
+    close();
+}
+
+bool ResultsStore::open(const string &directory)
+{
+    close();
+    dir = directory;
+
+    driverCount = (int)driverCatalog().size();
+    trackCount = (int)trackCatalog().size();
+    teamCount = (int)teams.size();
+    teamOfDriver.clear();
+    for (auto *driver : driverCatalog())
+        teamOfDriver.push_back(findTeam(driver->team));
+
+    offsets.clear();
+    positions.clear();
+    byTrack.assign(trackCount, vector<uint32_t>());
+    driverAgg.assign((size_t)(trackCount + 1) * driverCount, StandingStats());
+    teamAgg.assign((size_t)(trackCount + 1) * teamCount, StandingStats());
+
+    if (!recover())
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool ResultsStore::close()
+{
+    bool ok = flush();
+    for (FILE **f : {&logFile, &indexFile, &readFile})
+    {
+        if (*f && fclose(*f) != 0)
+            ok = false;
+        *f = nullptr;
+    }
+    return ok;
+}
+
+bool ResultsStore::recover()
+{
+    error_code ec;
+    fs::create_directories(dir, ec);
+    string logPath = dir + "/races.log";
+    string indexPath = dir + "/races.idx";
+
+    // Headers: create on first use, refuse files built for another roster
+
+    uint8_t logHeader[kLogHeaderSize];
+    memcpy(logHeader, kLogMagic, 4);
+    put32(logHeader + 4, kStoreVersion);
+
+    uint8_t indexHeader[kIndexHeaderSize];
+    memcpy(indexHeader, kIndexMagic, 4);
+    put32(indexHeader + 4, kStoreVersion);
+    put16(indexHeader + 8, (uint16_t)driverCount);
+    put16(indexHeader + 10, (uint16_t)trackCount);
+
+    for (auto &file : {make_pair(logPath, vector<uint8_t>(logHeader, logHeader + kLogHeaderSize)),
+                       make_pair(indexPath, vector<uint8_t>(indexHeader, indexHeader + kIndexHeaderSize))})
+    {
+        uintmax_t size = fs::exists(file.first, ec) ? fs::file_size(file.first, ec) : 0;
+        if (size < file.second.size())
+        {
+            FILE *f = fopen(file.first.c_str(), "wb");
+            if (!f)
+                return false;
+            bool ok = fwrite(file.second.data(), 1, file.second.size(), f) == file.second.size();
+            if (fclose(f) != 0 || !ok)
+                return false;
+            continue;
+        }
+
+        FILE *f = fopen(file.first.c_str(), "rb");
+        if (!f)
+            return false;
+        vector<uint8_t> found(file.second.size());
+        bool ok = fread(found.data(), 1, found.size(), f) == found.size();
+        fclose(f);
+        if (!ok || found != file.second)
+            return false;
+    }
+
+    // Load the index rows; drop any that point past the end of the log
+
+    uint64_t logSize = fs::file_size(logPath, ec);
+    size_t rowSize = 10 + (size_t)driverCount;
+    uint64_t validIndexBytes = kIndexHeaderSize;
+    uint64_t next = kLogHeaderSize;
+
+    readFile = fopen(logPath.c_str(), "rb");
+    FILE *idx = fopen(indexPath.c_str(), "rb");
+    if (!readFile || !idx)
+    {
+        if (idx)
+            fclose(idx);
+        return false;
+    }
+
+    // Rows are written in log order, so only the last surviving one needs
+    // checking against the log itself
+    uint64_t indexSize = fs::file_size(indexPath, ec);
+    size_t rowCount = (size_t)((indexSize - kIndexHeaderSize) / rowSize);
+    vector<uint8_t> rows(rowCount * rowSize);
+    seekTo(idx, kIndexHeaderSize);
+    rowCount = fread(rows.data(), 1, rows.size(), idx) / rowSize;
+
+    size_t keep = 0;
+    for (uint64_t prev = 0; keep < rowCount; ++keep)
+    {
+        uint64_t offset = get64(rows.data() + keep * rowSize);
+        if (offset < kLogHeaderSize || (keep > 0 && offset <= prev) || offset + 8 > logSize)
+            break;
+        prev = offset;
+    }
+    while (keep > 0)
+    {
+        uint64_t offset = get64(rows.data() + (keep - 1) * rowSize);
+        uint8_t lenBytes[4];
+        if (seekTo(readFile, offset) && fread(lenBytes, 1, 4, readFile) == 4 && offset + 8 + get32(lenBytes) <= logSize)
+        {
+            next = offset + 8 + get32(lenBytes);
+            break;
+        }
+        --keep;
+    }
+
+    positions.reserve(keep * driverCount);
+    offsets.reserve(keep);
+    for (size_t r = 0; r < keep; ++r)
+    {
+        const uint8_t *row = rows.data() + r * rowSize;
+        indexRace(get64(row), row[8], row + 10);
+    }
+    validIndexBytes += keep * rowSize;
+    fclose(idx);
+    if (fs::file_size(indexPath, ec) != validIndexBytes)
+        fs::resize_file(indexPath, validIndexBytes, ec);
+
+    indexFile = fopen(indexPath.c_str(), "ab");
+    if (!indexFile)
+        return false;
+
+    // Re-index records written after the last index row; stop at a torn tail
+
+    vector<uint8_t> payload;
+    vector<uint8_t> pos(driverCount);
+    seekTo(readFile, next);
+    while (true)
+    {
+        uint8_t lenBytes[4], crcBytes[4];
+        if (fread(lenBytes, 1, 4, readFile) != 4)
+            break;
+        uint32_t len = get32(lenBytes);
+        if (len < kRaceFixedBytes || next + 8 + len > logSize)
+            break;
+        payload.resize(len);
+        if (fread(payload.data(), 1, len, readFile) != len || fread(crcBytes, 1, 4, readFile) != 4)
+            break;
+        if (checksum(payload.data(), len) != get32(crcBytes))
+            break;
+
+        int cars = payload[11];
+        if (kRaceFixedBytes + cars * kCarBytes != len)
+            break;
+        fill(pos.begin(), pos.end(), 0);
+        for (int k = 0; k < cars; ++k)
+        {
+            int driver = payload[kRaceFixedBytes + k * kCarBytes];
+            if (driver < driverCount)
+                pos[driver] = (uint8_t)(k + 1);
+        }
+        if (!writeIndexRow(next, payload[8], pos.data()))
+            return false;
+        indexRace(next, payload[8], pos.data());
+        next += 8 + len;
+    }
+    if (logSize != next)
+        fs::resize_file(logPath, next, ec);
+    logEnd = next;
+
+    logFile = fopen(logPath.c_str(), "ab");
+    if (!logFile)
+        return false;
+
+    // Batch ingestion goes out in large writes
+    logBuffer.resize(kWriteBufferBytes);
+    indexBuffer.resize(kWriteBufferBytes / 4);
+    setvbuf(logFile, logBuffer.data(), _IOFBF, logBuffer.size());
+    setvbuf(indexFile, indexBuffer.data(), _IOFBF, indexBuffer.size());
+    return true;
+}
+
+void ResultsStore::indexRace(uint64_t offset, int track, const uint8_t *pos)
+{
+    uint32_t raceNo = (uint32_t)offsets.size();
+    offsets.push_back(offset);
+    positions.insert(positions.end(), pos, pos + driverCount);
+    if (track >= 0 && track < trackCount)
+        byTrack[track].push_back(raceNo);
+    else
+        track = -1;
+
+    int teamBest[64];
+    fill(teamBest, teamBest + min(teamCount, 64), 0);
+
+    for (int d = 0; d < driverCount; ++d)
+    {
+        int p = pos[d];
+        if (p == 0)
+            continue;
+        for (int t : {-1, track})
+        {
+            StandingStats &s = driverSlot(d, t);
+            s.starts++;
+            s.wins += (p == 1);
+            s.podiums += (p <= 3);
+            s.positionSum += p;
+            if (track == -1)
+                break;
+        }
+        int team = teamOfDriver[d];
+        if (team >= 0 && team < 64 && (teamBest[team] == 0 || p < teamBest[team]))
+            teamBest[team] = p;
+    }
+
+    for (int team = 0; team < min(teamCount, 64); ++team)
+    {
+        int p = teamBest[team];
+        if (p == 0)
+            continue;
+        for (int t : {-1, track})
+        {
+            StandingStats &s = teamSlot(team, t);
+            s.starts++;
+            s.wins += (p == 1);
+            s.podiums += (p <= 3);
+            s.positionSum += p;
+            if (track == -1)
+                break;
+        }
+    }
+}
+
+bool ResultsStore::writeIndexRow(uint64_t offset, int track, const uint8_t *pos)
+{
+    uint8_t head[10];
+    put64(head, offset);
+    head[8] = (uint8_t)track;
+    head[9] = 0;
+    return fwrite(head, 1, sizeof(head), indexFile) == sizeof(head) &&
+           fwrite(pos, 1, driverCount, indexFile) == (size_t)driverCount;
+}
+
+bool ResultsStore::append(const StoredRace &race)
+{
+    if (!logFile || race.classification.size() > 255)
+        return false;
+
+    size_t cars = race.classification.size();
+    size_t len = kRaceFixedBytes + cars * kCarBytes;
+    uint8_t record[8 + kRaceFixedBytes + 255 * kCarBytes];
+    uint8_t *p = record + 4;
+
+    put32(record, (uint32_t)len);
+    put64(p, race.seed);
+    p[8] = (uint8_t)race.track;
+    p[9] = (uint8_t)race.playerDriver;
+    p[10] = (uint8_t)race.source;
+    p[11] = (uint8_t)cars;
+    put16(p + 12, (uint16_t)race.totalLaps);
+    p[14] = (uint8_t)(race.fastestLapDriver < 0 ? 255 : race.fastestLapDriver);
+    p[15] = 0;
+    putFloat(p + 16, (float)race.fastestLap);
+
+    uint8_t pos[256] = {};
+    for (size_t k = 0; k < cars; ++k)
+    {
+        const StoredCar &car = race.classification[k];
+        uint8_t *c = p + kRaceFixedBytes + k * kCarBytes;
+        c[0] = (uint8_t)car.driver;
+        c[1] = (uint8_t)car.pitStops;
+        putFloat(c + 2, (float)car.totalTime);
+        if (car.driver >= 0 && car.driver < driverCount)
+            pos[car.driver] = (uint8_t)(k + 1);
+    }
+    put32(p + len, checksum(p, len));
+
+    // Log first: a crash between the two writes is repaired by recover()
+    uint64_t offset = logEnd;
+    if (fwrite(record, 1, 8 + len, logFile) != 8 + len)
+        return false;
+    logEnd += 8 + len;
+    if (!writeIndexRow(offset, race.track, pos))
+        return false;
+    indexRace(offset, race.track, pos);
+    return true;
+}
+
+bool ResultsStore::flush()
+{
+    bool ok = true;
+    if (logFile && fflush(logFile) != 0)
+        ok = false;
+    if (indexFile && fflush(indexFile) != 0)
+        ok = false;
+    return ok;
+}
+
+StandingStats ResultsStore::driverStats(int driver, int track) const
+{
+    if (driver < 0 || driver >= driverCount || track < -1 || track >= trackCount)
+        return StandingStats();
+    return driverAgg[(track + 1) * driverCount + driver];
+}
+
+StandingStats ResultsStore::teamStats(int team, int track) const
+{
+    if (team < 0 || team >= teamCount || track < -1 || track >= trackCount)
+        return StandingStats();
+    return teamAgg[(track + 1) * teamCount + team];
+}
+
+const vector<uint32_t> &ResultsStore::racesAtTrack(int track) const
+{
+    static const vector<uint32_t> none;
+    if (track < 0 || track >= trackCount)
+        return none;
+    return byTrack[track];
+}
+
+int ResultsStore::positionOf(uint64_t raceNo, int driver) const
+{
+    if (raceNo >= offsets.size() || driver < 0 || driver >= driverCount)
+        return 0;
+    return positions[raceNo * driverCount + driver];
+}
+
+bool ResultsStore::readRace(uint64_t raceNo, StoredRace &out)
+{
+    if (!readFile || raceNo >= offsets.size() || !flush())
+        return false;
+
+    uint8_t lenBytes[4];
+    if (!seekTo(readFile, offsets[raceNo]) || fread(lenBytes, 1, 4, readFile) != 4)
+        return false;
+    uint32_t len = get32(lenBytes);
+    vector<uint8_t> payload(len);
+    if (len < kRaceFixedBytes || fread(payload.data(), 1, len, readFile) != len)
+        return false;
+
+    const uint8_t *p = payload.data();
+    out.raceNo = raceNo;
+    out.seed = get64(p);
+    out.track = p[8];
+    out.playerDriver = p[9];
+    out.source = p[10];
+    out.totalLaps = get16(p + 12);
+    out.fastestLapDriver = p[14] == 255 ? -1 : p[14];
+    out.fastestLap = getFloat(p + 16);
+
+    size_t cars = p[11];
+    if (kRaceFixedBytes + cars * kCarBytes != len)
+        return false;
+    out.classification.resize(cars);
+    for (size_t k = 0; k < cars; ++k)
+    {
+        const uint8_t *c = p + kRaceFixedBytes + k * kCarBytes;
+        out.classification[k].driver = c[0];
+        out.classification[k].pitStops = c[1];
+        out.classification[k].totalTime = getFloat(c + 2);
+    }
+    return true;
+}
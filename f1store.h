@@ -0,0 +1,98 @@
+// F1 TERMINAL RACER 2025 - RESULTS STORE
+// Append-only race log with driver, team and track indexes for history queries.
+
+#ifndef F1STORE_H
+#define F1STORE_H
+
+#include "f1sim.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// ---------- Records ----------
+
+const int kRaceSourceBatch = 0;
+const int kRaceSourceHuman = 1;
+
+struct StoredCar
+{
+    int driver = -1;
+    int pitStops = 0;
+    double totalTime = 0.0;
+};
+
+struct StoredRace
+{
+    std::uint64_t raceNo = 0; // assigned by append
+    std::uint64_t seed = 0;
+    int track = -1, playerDriver = -1, source = kRaceSourceBatch, totalLaps = 0;
+    int fastestLapDriver = -1;
+    double fastestLap = 0.0;
+    std::vector<StoredCar> classification; // finishing order
+};
+
+void storedRaceFrom(const RaceState &race, int source, std::uint64_t seed, StoredRace &out);
+
+struct StandingStats
+{
+    long long starts = 0, wins = 0, podiums = 0, positionSum = 0;
+
+    double winRate() const { return starts ? (double)wins / starts : 0.0; }
+    double podiumRate() const { return starts ? (double)podiums / starts : 0.0; }
+    double meanPosition() const { return starts ? (double)positionSum / starts : 0.0; }
+};
+
+// ---------- Results Store ----------
+
+// races.log holds the full, checksummed records; races.idx holds one
+// fixed-width row per race (log offset, track, every driver's position).
+// Only the small index is read at open; a log tail the index missed after a
+// crash is re-indexed and a torn final record is truncated away.
+class ResultsStore
+{
+public:
+    ~ResultsStore();
+
+    bool open(const std::string &directory);
+    bool close();
+    bool isOpen() const { return logFile != nullptr; }
+
+    bool append(const StoredRace &race);
+    bool flush();
+
+    std::uint64_t raceCount() const { return offsets.size(); }
+
+    // track -1 covers every circuit. A team's result is its best car.
+    StandingStats driverStats(int driver, int track = -1) const;
+    StandingStats teamStats(int team, int track = -1) const;
+
+    // Race numbers held at a track, oldest first, and a driver's position
+    // in one of them (0 when not classified).
+    const std::vector<std::uint32_t> &racesAtTrack(int track) const;
+    int positionOf(std::uint64_t raceNo, int driver) const;
+
+    bool readRace(std::uint64_t raceNo, StoredRace &out);
+
+private:
+    bool recover();
+    void indexRace(std::uint64_t offset, int track, const std::uint8_t *positions);
+    bool writeIndexRow(std::uint64_t offset, int track, const std::uint8_t *positions);
+    StandingStats &driverSlot(int driver, int track) { return driverAgg[(track + 1) * driverCount + driver]; }
+    StandingStats &teamSlot(int team, int track) { return teamAgg[(track + 1) * teamCount + team]; }
+
+    std::string dir;
+    FILE *logFile = nullptr, *indexFile = nullptr, *readFile = nullptr;
+    std::uint64_t logEnd = 0;
+    int driverCount = 0, trackCount = 0, teamCount = 0;
+    std::vector<int> teamOfDriver;
+
+    std::vector<std::uint64_t> offsets;
+    std::vector<std::uint8_t> positions; // raceCount x driverCount
+    std::vector<std::vector<std::uint32_t>> byTrack;
+    std::vector<StandingStats> driverAgg, teamAgg;
+    std::vector<char> logBuffer, indexBuffer;
+};
+
+#endif
@@ -0,0 +1,589 @@
+// F1 TERMINAL RACER 2025 - TESTS
+// Engine checks run by ctest, one named check per invocation.
+
+#include "f1batch.h"
+#include "f1broadcast.h"
+#include "f1cache.h"
+#include "f1dashboard.h"
+#include "f1policy.h"
+#include "f1scenario.h"
+#include "f1sim_c.h"
+#include "f1store.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+// ---------- Harness ----------
+
+static int failures = 0;
+
+#define CHECK(cond)                                                                  \
+    do                                                                               \
+    {                                                                                \
+        if (!(cond))                                                                 \
+        {                                                                            \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                              \
+        }                                                                            \
+    } while (0)
+
+// A fresh directory under the working directory, removed on the way out
+struct ScratchDir
+{
+    explicit ScratchDir(const string &name) : path("f1tests-" + name)
+    {
+        error_code ec;
+        fs::remove_all(path, ec);
+        fs::create_directories(path, ec);
+    }
+    ~ScratchDir()
+    {
+        error_code ec;
+        fs::remove_all(path, ec);
+    }
+    string path;
+};
+
+static RaceScenario shortScenario()
+{
+    RaceScenario scenario;
+    scenario.track = 0;
+    scenario.playerDriver = 0;
+    scenario.totalLaps = 12;
+    return scenario;
+}
+
+static bool sameStats(const BatchStats &a, const BatchStats &b)
+{
+    return a.races == b.races && a.positionSum == b.positionSum && a.positionSqSum == b.positionSqSum &&
+           a.wins == b.wins && a.podiums == b.podiums && a.pitStops == b.pitStops;
+}
+
+// ---------- Checks ----------
+
+// Same results and finish orders on any thread count; a bad scenario is
+// zeroed, finish order included
+static void checkBatchThreads()
+{
+    const size_t count = 48;
+    const size_t bad = 17;
+    int32_t stride = f1_field_size();
+    vector<f1_scenario> scenarios(count);
+    vector<uint64_t> seeds(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        scenarios[i].track = (int32_t)(i % f1_track_count());
+        scenarios[i].player_driver = (int32_t)(i % f1_driver_count());
+        scenarios[i].total_laps = 10;
+        scenarios[i].strategy = (i % 3 == 0) ? "PSB" : nullptr;
+        seeds[i] = 1000 + i;
+    }
+    scenarios[bad].track = -1;
+
+    vector<f1_result> reference;
+    vector<int32_t> referenceOrder;
+    for (int threads : {1, 2, 3, 8})
+    {
+        vector<f1_result> results(count);
+        vector<int32_t> orders(count * stride, -7);
+        CHECK(f1_simulate_batch(scenarios.data(), seeds.data(), count, results.data(), orders.data(), threads) ==
+              F1SIM_ERR_SCENARIO);
+
+        CHECK(results[bad].player_position == 0 && results[bad].player_time == 0.0);
+        for (int32_t k = 0; k < stride; ++k)
+            CHECK(orders[bad * stride + k] == 0);
+        CHECK(results[0].player_position > 0);
+
+        if (reference.empty())
+        {
+            reference = results;
+            referenceOrder = orders;
+            continue;
+        }
+        CHECK(memcmp(results.data(), reference.data(), count * sizeof(f1_result)) == 0);
+        CHECK(orders == referenceOrder);
+    }
+}
+
+// Every 2-bit cell survives a save and load; a cut file is refused
+static void checkPolicyRoundTrip()
+{
+    ScratchDir dir("policy");
+    string path = dir.path + "/policy.bin";
+
+    PolicyTable table;
+    table.trackCount = (int)trackCatalog().size();
+    table.driverCount = (int)driverCatalog().size();
+    size_t cells = (size_t)table.trackCount * table.driverCount * kPolicyLapBuckets * kPolicyTyreBuckets *
+                   kPolicyVehicleBuckets * kPolicyGapBuckets;
+    table.actions.resize(cells);
+    for (size_t i = 0; i < cells; ++i)
+        table.actions[i] = (uint8_t)((i * 7 + i / 5) % 4);
+    CHECK(savePolicyTable(table, path));
+
+    PolicyTable loaded;
+    CHECK(loadPolicyTable(loaded, path));
+    CHECK(loaded.trackCount == table.trackCount && loaded.driverCount == table.driverCount);
+    CHECK(loaded.actions == table.actions);
+
+    error_code ec;
+    fs::resize_file(path, fs::file_size(path) - 1, ec);
+    PolicyTable cut;
+    CHECK(!loadPolicyTable(cut, path));
+    CHECK(cut.empty());
+}
+
+// A torn final record is truncated away; the store keeps appending after it
+static void checkStoreRecovery()
+{
+    ScratchDir dir("store");
+    RaceScenario scenario = shortScenario();
+    const int races = 5;
+
+    ResultsStore store;
+    CHECK(store.open(dir.path));
+    RaceState race;
+    for (int i = 0; i < races; ++i)
+    {
+        CHECK(simulateRace(scenario, 50 + i, race));
+        StoredRace stored;
+        storedRaceFrom(race, kRaceSourceBatch, 50 + i, stored);
+        CHECK(store.append(stored));
+    }
+    CHECK(store.close());
+
+    string logPath = dir.path + "/races.log";
+    error_code ec;
+    fs::resize_file(logPath, fs::file_size(logPath) - 3, ec);
+    CHECK(!ec);
+
+    CHECK(store.open(dir.path));
+    CHECK(store.raceCount() == races - 1);
+    StoredRace back;
+    CHECK(store.readRace(races - 2, back));
+    CHECK(back.seed == 50 + races - 2);
+    CHECK(!store.readRace(races - 1, back));
+
+    StoredRace again;
+    storedRaceFrom(race, kRaceSourceBatch, 99, again);
+    CHECK(store.append(again));
+    CHECK(store.close());
+
+    CHECK(store.open(dir.path));
+    CHECK(store.raceCount() == races);
+    CHECK(store.readRace(races - 1, back) && back.seed == 99);
+    CHECK(store.close());
+}
+
+// Full ring refuses one more, frees a slot per pop, and keeps order
+// across wrap-around with a producer and a consumer thread
+static void checkSpscRing()
+{
+    SpscRing<int, 8> ring;
+    for (int i = 0; i < 8; ++i)
+        CHECK(ring.tryPush(i));
+    CHECK(!ring.tryPush(8));
+
+    int value = -1;
+    CHECK(ring.tryPop(value) && value == 0);
+    CHECK(ring.tryPush(8));
+    CHECK(!ring.tryPush(9));
+    for (int i = 1; i <= 8; ++i)
+        CHECK(ring.tryPop(value) && value == i);
+    CHECK(!ring.tryPop(value));
+
+    const int items = 200000;
+    SpscRing<int, 16> shared;
+    thread producer([&] {
+        for (int i = 0; i < items;)
+        {
+            if (shared.tryPush(i))
+                ++i;
+            else
+                this_thread::yield();
+        }
+    });
+    int expected = 0;
+    bool ordered = true;
+    while (expected < items)
+    {
+        if (shared.tryPop(value))
+            ordered = ordered && value == expected++;
+        else
+            this_thread::yield();
+    }
+    producer.join();
+    CHECK(ordered);
+    CHECK(!shared.tryPop(value));
+}
+
+// Stats stitched from cached ranges equal one pass over the whole range
+static void checkCacheStitching()
+{
+    ScratchDir dir("cache");
+    RaceScenario scenario = shortScenario();
+
+    ResultCache cache;
+    CHECK(cache.open(dir.path));
+    cache.query(scenario, 0, 60, 2);
+    cache.query(scenario, 100, 150, 2);
+
+    CacheQueryInfo info;
+    BatchStats stitched = cache.query(scenario, 0, 200, 2, &info);
+    CHECK(info.rangesUsed == 2);
+    CHECK(info.cachedRaces == 110 && info.simulatedRaces == 90);
+    CHECK(sameStats(stitched, simulateSeedRange(scenario, 0, 200)));
+
+    // A second process sees the stored ranges too
+    ResultCache reopened;
+    CHECK(reopened.open(dir.path));
+    CacheQueryInfo again;
+    CHECK(sameStats(reopened.query(scenario, 0, 200, 1, &again), stitched));
+    CHECK(again.simulatedRaces == 0);
+}
+
+// Minimum samples for many strategies never push a wave past waveSize or
+// the run past maxRaces
+static void checkAdaptiveBudget()
+{
+    RaceScenario base = shortScenario();
+    vector<string> plans = {"P", "S", "B", "PS", "SP", "PB", "SB", "BS", "PP", "SS"};
+    vector<string_view> strategies(plans.begin(), plans.end());
+
+    AdaptiveOptions options;
+    options.minRaces = 128;
+    options.waveSize = 512;
+    options.precision = 0.0;
+    options.threads = 2;
+    for (long long maxRaces : {300LL, 700LL, 2000LL})
+    {
+        options.maxRaces = maxRaces;
+        AdaptiveReport report = compareStrategiesAdaptive(base, strategies, options);
+        CHECK(!report.scenarioError);
+        CHECK(report.totalRaces <= maxRaces);
+        CHECK(report.totalRaces <= (long long)report.waves * options.waveSize);
+        long long counted = 0;
+        for (const StrategyEstimate &e : report.estimates)
+            counted += e.stat.n;
+        CHECK(counted == report.totalRaces);
+    }
+}
+
+// A strategy against itself on common draws differs by exactly nothing;
+// a scenario that cannot be raced is reported, not averaged in as P0
+static void checkPairedIdentical()
+{
+    RaceScenario base = shortScenario();
+    PairedOptions options;
+    options.races = 64;
+    options.threads = 2;
+    for (bool antithetic : {false, true})
+    {
+        options.antithetic = antithetic;
+        PairedReport report = compareStrategiesPaired(base, "PSB", "PSB", options);
+        CHECK(!report.scenarioError);
+        CHECK(report.races == 128);
+        CHECK(report.position.diff.mean == 0.0 && report.raceTime.diff.mean == 0.0);
+        CHECK(report.position.a.mean == report.position.b.mean);
+        CHECK(report.position.a.mean >= 1.0);
+    }
+
+    RaceScenario bad = base;
+    bad.playerDriver = -1;
+    CHECK(compareStrategiesPaired(bad, "P", "S", options).scenarioError);
+
+    PolicyTable misshapen;
+    misshapen.trackCount = (int)trackCatalog().size();
+    misshapen.driverCount = (int)driverCatalog().size();
+    misshapen.actions.assign(16, kPolicyNeutral);
+    bad = base;
+    bad.policy = &misshapen;
+    CHECK(compareStrategiesPaired(bad, "P", "S", options).scenarioError);
+}
+
+// Stops go out in pit-entry order within a lap, and holds carried from a
+// lapped car's stop do not queue a car that entered earlier in race time
+static void checkPitOrdering()
+{
+    RaceScenario scenario = shortScenario();
+    scenario.totalLaps = 1;
+    RaceState race;
+    CHECK(simulateRace(scenario, 3, race));
+
+    // Two teammates and a car from another team
+    int a = 0, mate = -1, other = -1;
+    for (int i = 1; i < (int)race.field.size(); ++i)
+    {
+        if (race.field[i].teamId == race.field[a].teamId && mate < 0)
+            mate = i;
+        if (race.field[i].teamId != race.field[a].teamId && other < 0)
+            other = i;
+    }
+    CHECK(mate > 0 && other > 0);
+    if (mate < 0 || other < 0)
+        return;
+
+    race.boxFree.assign(race.boxFree.size(), PitHold());
+    race.laneClear = PitHold();
+    auto waitOf = [&](vector<PitEvent> stops, int car)
+    {
+        for (Racer &r : race.field)
+            r.lastLapTime = 0.0;
+        race.pitQueue.assign(stops.begin(), stops.end());
+        make_heap(race.pitQueue.begin(), race.pitQueue.end(),
+                  [](const PitEvent &x, const PitEvent &y) { return x.arrival > y.arrival; });
+        resolvePitStops(race);
+        CHECK(race.pitQueue.empty());
+        return race.field[car].lastLapTime;
+    };
+
+    // Queued behind the teammate in the box, whichever was queued first
+    CHECK(abs(waitOf({{100.5, mate}, {100.0, a}}, mate) - 2.0) < 1e-9);
+    CHECK(race.field[a].lastLapTime == 0.0);
+
+    // Next lap: earlier entries than the carried holds go straight through
+    CHECK(waitOf({{90.0, other}}, other) == 0.0);
+    CHECK(waitOf({{95.0, a}}, a) == 0.0);
+
+    // A later entry still waits for the lane behind the teammate
+    CHECK(abs(waitOf({{101.0, other}}, other) - 2.5) < 1e-9);
+}
+
+static bool sameSnapshot(const BroadcastSnapshot &a, const BroadcastSnapshot &b)
+{
+    if (a.tick != b.tick || a.cars.size() != b.cars.size())
+        return false;
+    for (size_t i = 0; i < a.cars.size(); ++i)
+    {
+        const BroadcastCar &x = a.cars[i], &y = b.cars[i];
+        if (x.driver != y.driver || x.position != y.position || x.tyre != y.tyre || x.vehicle != y.vehicle ||
+            x.pitStops != y.pitStops || x.flags != y.flags || x.gapMs != y.gapMs || x.lastLapMs != y.lastLapMs)
+            return false;
+    }
+    return true;
+}
+
+// Every frame of a race decodes back to its snapshot; a subscriber that
+// misses deltas catches up on the next one, and a cut frame is refused
+static void checkBroadcastCodec()
+{
+    RaceScenario scenario = shortScenario();
+    scenario.totalLaps = 30;
+    mt19937 gen(mixSeed(11));
+    RaceState race;
+    startRace(race, *driverCatalog()[0], driverCatalog()[0]->name, *trackCatalog()[0], scenario.totalLaps, gen);
+
+    BroadcastEncoder encoder(7);
+    BroadcastDecoder every, sparse;
+    BroadcastSnapshot snapshot;
+    int keyframes = 0;
+    for (uint32_t tick = 0; tick < (uint32_t)scenario.totalLaps; ++tick)
+    {
+        simulateLap(race, tick % 5 == 4 ? 3 : 1, gen);
+        snapshotRace(race, tick, snapshot);
+        if (tick == 12)
+        {
+            // Extremes both ways exercise the widest varints
+            snapshot.cars[0].gapMs = 0xFFFFFFFFu;
+            snapshot.cars[1].lastLapMs = 0;
+        }
+        const vector<uint8_t> &frame = encoder.encode(snapshot);
+        keyframes += encoder.lastWasKeyframe();
+
+        CHECK(every.apply(frame.data(), frame.size()));
+        CHECK(sameSnapshot(every.state(), snapshot));
+        if (encoder.lastWasKeyframe() || tick % 3 == 0)
+        {
+            CHECK(sparse.apply(frame.data(), frame.size()));
+            CHECK(sameSnapshot(sparse.state(), snapshot));
+        }
+        CHECK(!every.apply(frame.data(), frame.size() - 1));
+    }
+    CHECK(keyframes == 5);
+
+    // A delta cut from a keyframe the decoder never saw is refused
+    BroadcastDecoder late;
+    const vector<uint8_t> &frame = encoder.encode(snapshot);
+    CHECK(!encoder.lastWasKeyframe());
+    CHECK(!late.apply(frame.data(), frame.size()));
+    CHECK(!late.ready());
+}
+
+// Good lines parse in file order with comments and blanks skipped, each bad
+// line is reported with its number, and a streamed run matches direct runs
+static void checkScenarioParser()
+{
+    ScratchDir dir("scenarios");
+    string path = dir.path + "/list.txt";
+    FILE *f = fopen(path.c_str(), "wb");
+    CHECK(f != nullptr);
+    if (!f)
+        return;
+    fputs("# track; driver; strategy; seeds; grid; laps\n"
+          "Monaco; Max Verstappen; PSSB; 0-40; ; 8\n"
+          "\n"
+          "Atlantis; Max Verstappen; P; 10\n"
+          "Monaco; Nobody; P; 10\n"
+          "Monaco; Max Verstappen; P; 9-3\n"
+          "Monaco; Max Verstappen; P; x\n"
+          "Monaco; Max Verstappen; P; 10; Nobody\n"
+          "Monaco; Max Verstappen; P; 10; ; 0\n"
+          "Monaco; Max Verstappen; P; 10; ; 5; extra\n"
+          "   Spa ; Lando Norris ;  ; 100-130 ; Lando Norris, Charles Leclerc ; 6   # trailing comment\n"
+          "Monaco; Max Verstappen; S; 25",
+          f);
+    fclose(f);
+
+    ScenarioStream stream;
+    CHECK(stream.open(path));
+    vector<StreamedScenario> parsed;
+    StreamedScenario s;
+    string errors;
+    while (stream.next(s, &errors))
+        parsed.push_back(s);
+    CHECK(stream.bytesRead() == stream.size());
+    CHECK(errors == "line 4: unknown track\n"
+                    "line 5: unknown driver\n"
+                    "line 6: bad seed range\n"
+                    "line 7: bad seed range\n"
+                    "line 8: unknown driver on grid\n"
+                    "line 9: bad lap count\n"
+                    "line 10: too many fields\n");
+
+    CHECK(parsed.size() == 3);
+    if (parsed.size() != 3)
+        return;
+    CHECK(parsed[0].line == 2 && parsed[0].trackName == "Monaco" && parsed[0].scenario.strategy == "PSSB");
+    CHECK(parsed[0].seedBegin == 0 && parsed[0].seedEnd == 40 && parsed[0].scenario.totalLaps == 8);
+    CHECK(parsed[1].line == 11 && parsed[1].driverName == "Lando Norris" && parsed[1].scenario.strategy.empty());
+    CHECK(parsed[1].seedBegin == 100 && parsed[1].seedEnd == 130 && parsed[1].scenario.totalLaps == 6);
+    CHECK(parsed[1].scenario.gridSize == 2 && parsed[1].scenario.grid[1] == findDriver("Charles Leclerc"));
+    CHECK(parsed[2].line == 12 && parsed[2].seedEnd == 25 && parsed[2].scenario.totalLaps == kDefaultRaceLaps);
+    stream.close();
+
+    // Streamed in small pieces, results arrive in file order and match
+    ScenarioStream again;
+    CHECK(again.open(path));
+    StreamRunOptions options;
+    options.threads = 3;
+    options.pieceSize = 7;
+    size_t seen = 0;
+    int errorCount = 0;
+    size_t ran = runScenarioStream(
+        again, options,
+        [&](const StreamedScenario &done, const BatchStats &stats)
+        {
+            CHECK(seen < parsed.size() && done.line == parsed[seen].line);
+            CHECK(sameStats(stats, simulateSeedRange(done.scenario, done.seedBegin, done.seedEnd)));
+            seen++;
+        },
+        [&](const string &) { errorCount++; });
+    CHECK(ran == 3 && seen == 3);
+    CHECK(errorCount > 0);
+}
+
+// Lap times come back from the zigzag varint deltas to the millisecond,
+// through sign changes, multi-byte deltas and buffer restarts; stints past
+// the last slot merge without losing laps
+static void checkHistoryVarints()
+{
+    CarHistory history;
+    vector<double> laps; // by lap number, from 1
+    laps.push_back(0.0);
+    bool restarted = false;
+    const double pattern[] = {90.123, 90.124, 85.0, 200.5, 30.0, 1000.0, 31.001, 91.999, 92.0005, 30.0};
+    for (int lap = 1; lap <= 120; ++lap)
+    {
+        double t = pattern[lap % 10] + (lap % 7) * 0.013;
+        laps.push_back(t);
+        history.recordLap(lap, t, 80.0, false);
+
+        double back[64];
+        int first = 0;
+        int count = history.recentLaps(back, 64, &first);
+        CHECK(count > 0 && first + count - 1 == lap);
+        restarted = restarted || first > 1;
+        for (int k = 0; k < count; ++k)
+            CHECK(llround(back[k] * 1000.0) == llround(laps[first + k] * 1000.0));
+
+        // Asking for fewer gives the newest ones
+        double newest[3];
+        int shortFirst = 0;
+        int shortCount = history.recentLaps(newest, 3, &shortFirst);
+        CHECK(shortCount == min(count, 3) && shortFirst + shortCount - 1 == lap);
+    }
+    CHECK(restarted);
+    CHECK(history.currentStint().laps == 120 && history.stintCount() == 0);
+
+    // A stop per lap fills every slot, then the oldest pairs merge
+    CarHistory stints;
+    double total = 0.0;
+    for (int lap = 1; lap <= 3 * kStintSlots; ++lap)
+    {
+        stints.recordLap(lap, 90.0 + lap, 100.0 - lap, true);
+        total += 90.0 + lap;
+    }
+    CHECK(stints.stintCount() == kStintSlots);
+    int lapSum = 0;
+    double timeSum = 0.0;
+    for (int i = 0; i < stints.stintCount(); ++i)
+    {
+        lapSum += stints.stint(i).laps;
+        timeSum += stints.stint(i).totalTime;
+    }
+    CHECK(lapSum == 3 * kStintSlots && abs(timeSum - total) < 1e-6);
+    CHECK(stints.stint(0).firstLap == 1 && stints.stint(kStintSlots - 1).firstLap == 3 * kStintSlots);
+    CHECK(stints.currentStint().laps == 0);
+}
+
+// ---------- Main ----------
+
+int main(int argc, char **argv)
+{
+    struct Check
+    {
+        const char *name;
+        void (*run)();
+    };
+    const Check checks[] = {
+        {"batch-threads", checkBatchThreads},
+        {"policy-roundtrip", checkPolicyRoundTrip},
+        {"store-recovery", checkStoreRecovery},
+        {"spsc-ring", checkSpscRing},
+        {"cache-stitching", checkCacheStitching},
+        {"adaptive-budget", checkAdaptiveBudget},
+        {"paired-identical", checkPairedIdentical},
+        {"pit-ordering", checkPitOrdering},
+        {"broadcast-codec", checkBroadcastCodec},
+        {"scenario-parser", checkScenarioParser},
+        {"history-varints", checkHistoryVarints},
+    };
+
+    int ran = 0;
+    for (const Check &check : checks)
+    {
+        if (argc > 1 && strcmp(argv[1], check.name) != 0)
+            continue;
+        check.run();
+        ran++;
+    }
+    if (ran == 0)
+    {
+        fprintf(stderr, "usage: f1tests [check]\n");
+        return 2;
+    }
+    if (failures)
+        fprintf(stderr, "%d check(s) failed\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,174 @@
+// F1 TERMINAL RACER 2025 - TRACK MAP
+
+#include "f1trackmap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+
+// ---------- Rasterising ----------
+
+// Splits a UTF-8 line into one string per code point (one column each)
+static vector<string> splitGlyphs(const string &line)
+{
+    vector<string> glyphs;
+    for (size_t i = 0; i < line.size();)
+    {
+        unsigned char c = (unsigned char)line[i];
+        size_t len = c < 0x80 ? 1 : (c >> 5) == 0x6 ? 2 : (c >> 4) == 0xE ? 3 : 4;
+        glyphs.push_back(line.substr(i, len));
+        i += len;
+    }
+    return glyphs;
+}
+
+TrackMap::TrackMap(const string &asciiMap)
+{
+    size_t start = 0;
+    while (start <= asciiMap.size())
+    {
+        size_t newline = asciiMap.find('\n', start);
+        if (newline == string::npos)
+            newline = asciiMap.size();
+        vector<string> row = splitGlyphs(asciiMap.substr(start, newline - start));
+        if (!row.empty() && row.front() == "│")
+            row.erase(row.begin());
+        if (!row.empty() && row.back() == "│")
+            row.pop_back();
+        width = max(width, (int)row.size());
+        grid.push_back(row);
+        start = newline + 1;
+    }
+    for (auto &row : grid)
+        row.resize(width, " ");
+
+    // Walk the drawn line: from the first cell, always step to the closest
+    // unvisited one, preferring to keep the current heading. Gaps in the
+    // drawing are jumped by distance.
+
+    pathIndexAt.assign(grid.size() * width, -1);
+    vector<char> open(grid.size() * width, 0);
+    int remaining = 0;
+    for (int r = 0; r < rows(); ++r)
+        for (int c = 0; c < width; ++c)
+            if (grid[r][c] != " ")
+            {
+                open[r * width + c] = 1;
+                remaining++;
+            }
+
+    int r = -1, c = -1, dr = 0, dc = 1;
+    for (int i = 0; i < (int)open.size() && r < 0; ++i)
+    {
+        if (open[i])
+        {
+            r = i / width;
+            c = i % width;
+        }
+    }
+
+    while (remaining > 0)
+    {
+        open[r * width + c] = 0;
+        pathIndexAt[r * width + c] = (int)path.size();
+        path.push_back({r, c});
+        if (--remaining == 0)
+            break;
+
+        // Rows are about twice as tall as columns are wide
+        int bestR = -1, bestC = -1;
+        double bestScore = 1e18;
+        for (int rr = 0; rr < rows(); ++rr)
+            for (int cc = 0; cc < width; ++cc)
+            {
+                if (!open[rr * width + cc])
+                    continue;
+                double dy = 2.0 * (rr - r), dx = cc - c;
+                double score = dx * dx + dy * dy;
+                if (rr - r == dr && cc - c == dc)
+                    score -= 0.5; // keep going the same way on ties
+                if (score < bestScore)
+                {
+                    bestScore = score;
+                    bestR = rr;
+                    bestC = cc;
+                }
+            }
+        dr = bestR - r;
+        dc = bestC - c;
+        r = bestR;
+        c = bestC;
+    }
+
+    wanted.assign(path.size(), nullptr);
+    shown.assign(path.size(), nullptr);
+    wantedPriority.assign(path.size(), 0);
+}
+
+size_t TrackMap::cellAt(double lapFraction) const
+{
+    if (path.empty())
+        return 0;
+    double f = lapFraction - floor(lapFraction);
+    return min(path.size() - 1, (size_t)(f * path.size()));
+}
+
+// ---------- Drawing ----------
+
+void TrackMap::plot(const MapMarker *markers, size_t count)
+{
+    fill(wanted.begin(), wanted.end(), nullptr);
+    if (path.empty())
+        return;
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t cell = cellAt(markers[i].lapFraction);
+        if (!wanted[cell] || markers[i].priority > wantedPriority[cell])
+        {
+            wanted[cell] = markers[i].glyph;
+            wantedPriority[cell] = markers[i].priority;
+        }
+    }
+}
+
+void TrackMap::drawCell(string &out, size_t pathIndex) const
+{
+    const Cell &cell = path[pathIndex];
+    out += wanted[pathIndex] ? wanted[pathIndex] : grid[cell.row][cell.col].c_str();
+}
+
+void TrackMap::renderRow(string &out, int row)
+{
+    for (int c = 0; c < width; ++c)
+    {
+        int index = pathIndexAt[row * width + c];
+        if (index < 0)
+        {
+            out += grid[row][c];
+            continue;
+        }
+        drawCell(out, index);
+        shown[index] = wanted[index];
+    }
+}
+
+void TrackMap::renderChanges(string &out, int indent)
+{
+    char move[32];
+    for (size_t i = 0; i < path.size(); ++i)
+    {
+        if (wanted[i] == shown[i])
+            continue;
+        // Up to the cell's row, across to its column, draw, then come back
+        int up = rows() - path[i].row;
+        snprintf(move, sizeof(move), "\033[%dA\033[%dG", up, indent + path[i].col + 1);
+        out += move;
+        drawCell(out, i);
+        snprintf(move, sizeof(move), "\033[%dB\r", up);
+        out += move;
+        shown[i] = wanted[i];
+    }
+}
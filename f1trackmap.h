@@ -0,0 +1,62 @@
+// F1 TERMINAL RACER 2025 - TRACK MAP
+// Track::asciiMap rasterised into an ordered racing line for live car plots.
+
+#ifndef F1TRACKMAP_H
+#define F1TRACKMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ---------- Markers ----------
+
+struct MapMarker
+{
+    double lapFraction = 0.0; // 0..1 from the start line, wraps
+    const char *glyph = "o";  // one terminal column, may carry colour codes
+    int priority = 0;         // higher wins a shared cell
+};
+
+// ---------- Track Map ----------
+
+// The map's path characters are ordered into a loop once, at construction,
+// so placing a car is one multiply. plot() updates the markers; render()
+// draws the whole map and renderChanges() only the cells whose marker
+// changed since the last draw, as cursor-relative escape sequences.
+class TrackMap
+{
+public:
+    // The map's own frame (a '│' at each end of a row) is dropped.
+    explicit TrackMap(const std::string &asciiMap);
+
+    int rows() const { return (int)grid.size(); }
+    int columns() const { return width; }
+    std::size_t pathLength() const { return path.size(); }
+    std::size_t cellAt(double lapFraction) const;
+
+    void plot(const MapMarker *markers, std::size_t count);
+
+    // One map row, padded to columns(), no newline.
+    void renderRow(std::string &out, int row);
+    // Cursor must sit at the start of the line below the map, indent
+    // columns to the left of it; it is left there.
+    void renderChanges(std::string &out, int indent);
+
+private:
+    struct Cell
+    {
+        int row, col;
+    };
+
+    void drawCell(std::string &out, std::size_t pathIndex) const;
+
+    std::vector<std::vector<std::string>> grid; // one UTF-8 glyph per column
+    int width = 0;
+    std::vector<Cell> path;
+    std::vector<int> pathIndexAt; // row * width + col -> path index, -1 off path
+    std::vector<const char *> wanted, shown; // marker per path cell, nullptr for track
+    std::vector<int> wantedPriority;
+};
+
+#endif